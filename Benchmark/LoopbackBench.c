@@ -0,0 +1,628 @@
+//==============================================================================
+// Title:		End-to-end loopback benchmark of the frame link.
+// Description:	A transmitter stand-in thread encodes frames exactly like
+//				Transmitter.c and writes them into one end of a pseudo-terminal
+//				pair (or a socketpair). The receiver thread runs the monitor's
+//				receive path from MagnoCore on the other end: it drains the
+//				bytes into the frame decoder and decodes runs of vectors with
+//				their magnitudes into a lock-free ring. A consumer thread
+//				stands in for the monitor's UI thread and appends them to a
+//				sample store.
+//				The frames carry sequence numbers, so lost frames are counted
+//				by the receive path itself. Each test vector also carries its
+//				send time in x to measure the end-to-end latency of every
+//				vector, in microseconds since the start so it survives the
+//				fixed-point encoding. The link is driven at increasing rates
+//				and one line is printed per rate.
+//
+//				Usage: LoopbackBench [-t pty|socketpair] [-d seconds]
+//				                     [-r rate,rate,...] [-e corruption]
+//				                     [-f fixed|float64] [-n vectors]
+//				                     [-q spsc|locked]
+//				A rate of 0 sends as fast as the link accepts. -e corrupts one
+//				byte in that fraction of the frames to exercise the checksum.
+//				-f selects the wire encoding, fixed point by default. -n sets
+//				the vectors per block frame like the transmitter, 1 sends
+//				single-vector frames. -q locked replaces the ring with the
+//				monitor's former handoff for comparison: a mutex-guarded
+//				byte queue read in blocks of 16 vectors, and a lock taken
+//				around every read of the link.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "Acquisition.h"
+#include "MagnoAtomic.h"
+#include "Pacer.h"
+#include "SampleStore.h"
+#include "SpscRing.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define MAX_RATES				32
+#define VECTORS_PER_WRITE		256 	// Vectors the sender batches per write
+#define MAX_VECTORS_PER_READ	256 	// Same run length as the monitor
+#define DRAIN_TIMEOUT_MS		200 	// Receiver gives up this long after the sender stops
+#define SEND_TIME_UNIT			(1e-6 / FRAME_FIXED_LSB) // Seconds per unit of the send time in x
+#define RING_VECTORS			65536 	// Same ring size as the monitor
+#define LOCKED_BLOCK			(16 * FRAME_VECTOR_SIZE) // Bytes the locked consumer reads at once
+#define LOCKED_QUEUE_BYTES		(2 * 1024 * 1024) // Power of two, about the ring's capacity
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	int sendFd;
+	int receiveFd;
+	double rate;					// Vectors per second, 0 for unlimited
+	double duration;				// Seconds to send for
+	double corruption;				// Fraction of frames with a corrupted byte
+	int encoding;					// FRAME_TYPE_FIXED24 or FRAME_TYPE_FLOAT64
+	int blockSize;					// Vectors per frame, block frames when above 1
+	double start;					// Clock at the start, origin of the send times
+	AtomicIndex sending;			// Cleared when the sender is done
+	unsigned long vectorsSent;
+	double sendSeconds;
+} Link;
+
+typedef struct
+{
+	unsigned long received;
+	unsigned long lost;				// Sequence numbers never received
+	unsigned int checksumFailures;
+	unsigned int bytesSkipped;
+	double seconds;					// First to last received vector
+	unsigned long firstVectors;		// Vectors taken at the start of seconds
+	double *latencies;
+	size_t numLatencies;
+	size_t latencyCapacity;
+} Result;
+
+typedef struct
+{
+	int locked;						// Mutex-guarded byte queue instead of the vector ring
+	SpscRing ring;					// Vectors, or bytes when locked
+	pthread_mutex_t queueMutex;		// Guards the byte queue when locked
+	pthread_mutex_t receiveMutex;	// Taken around every read when locked
+	AtomicIndex receiving;			// Cleared when the receiver is done
+	const Link *link;
+	Result *result;
+	int error;
+} Handoff;
+
+//-----------------------------------------------------------------------------
+// Monotonic clock in seconds
+//-----------------------------------------------------------------------------
+static double Now (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void SleepSeconds (double seconds)
+{
+	struct timespec ts;
+
+	ts.tv_sec = (time_t)seconds;
+	ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1e9);
+	nanosleep (&ts, NULL);
+}
+
+static int WriteAll (int fd, const unsigned char *data, size_t size)
+{
+	ssize_t written;
+
+	while (size > 0)
+	{
+		written = write (fd, data, size);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		data += written;
+		size -= (size_t)written;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Open a connected pair of descriptors. A pty is set to raw mode so the line
+// discipline passes every byte unchanged, like a serial port would.
+//-----------------------------------------------------------------------------
+static int OpenTransport (const char *transport, int *sendFd, int *receiveFd)
+{
+	struct termios attributes;
+	int fds[2];
+	int master;
+	int slave;
+
+	if (strcmp(transport, "socketpair") == 0)
+	{
+		if (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+			return -1;
+		*sendFd = fds[0];
+		*receiveFd = fds[1];
+		return 0;
+	}
+	if (strcmp(transport, "pty") != 0)
+		return -1;
+
+	master = posix_openpt (O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt (master) < 0 || unlockpt (master) < 0)
+		return -1;
+	slave = open (ptsname (master), O_RDWR | O_NOCTTY);
+	if (slave < 0)
+		return -1;
+
+	tcgetattr (slave, &attributes);
+	cfmakeraw (&attributes);
+	tcsetattr (slave, TCSANOW, &attributes);
+	tcgetattr (master, &attributes);
+	cfmakeraw (&attributes);
+	tcsetattr (master, TCSANOW, &attributes);
+
+	*sendFd = master;
+	*receiveFd = slave;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Transmitter stand-in, paced like the transmitter to rate vectors/s
+//-----------------------------------------------------------------------------
+static void *SendThread (void *data)
+{
+	Link *link = (Link*)data;
+	unsigned char frames[VECTORS_PER_WRITE * FRAME_MAX_VECTOR_COST];
+	FrameSample samples[VECTORS_PER_WRITE];
+	double start = Now ();
+	double now = start;
+	double wait;
+	Pacer pacer;
+	unsigned int due;
+	unsigned int numVectors;
+	unsigned int numInFrame;
+	unsigned int i;
+	unsigned int seed = 1;
+	size_t numBytes;
+	int frameSize;
+
+	PacerInit (&pacer, link->rate, link->blockSize, start);
+	link->vectorsSent = 0;
+	while (now - start < link->duration)
+	{
+		due = link->rate > 0 ? PacerDue (&pacer, now, VECTORS_PER_WRITE) : VECTORS_PER_WRITE;
+		if (due == 0)
+		{
+			wait = PacerNextDeadline (&pacer, now) - now;
+			if (wait > 0)
+				SleepSeconds (wait);
+			now = Now ();
+			continue;
+		}
+
+		for (numVectors = 0; numVectors < due; numVectors++)
+		{
+			samples[numVectors].sequence = (unsigned int)link->vectorsSent++;
+			samples[numVectors].timestamp = (unsigned long long)(now / FRAME_TIMESTAMP_UNIT);
+			samples[numVectors].vector[0] = (now - link->start) / SEND_TIME_UNIT;
+			samples[numVectors].vector[1] = 0.0;
+			samples[numVectors].vector[2] = 0.0;
+		}
+
+		for (i = 0, numBytes = 0; i < numVectors; i += numInFrame, numBytes += frameSize)
+		{
+			numInFrame = numVectors - i < (unsigned int)link->blockSize ? numVectors - i : (unsigned int)link->blockSize;
+			if (link->blockSize > 1)
+				frameSize = FrameEncodeBlock (samples + i, numInFrame, link->encoding, frames + numBytes);
+			else
+				frameSize = FrameEncode (samples + i, link->encoding, frames + numBytes);
+
+			if (link->corruption > 0 && rand_r (&seed) < link->corruption * RAND_MAX)
+				frames[numBytes + FRAME_HEADER_SIZE + rand_r (&seed) % (frameSize - FRAME_HEADER_SIZE)] ^= 0x10;
+		}
+		if (WriteAll (link->sendFd, frames, numBytes) < 0)
+			break;
+		now = Now ();
+	}
+
+	link->sendSeconds = now - start;
+	AtomicStore (&link->sending, 0);
+	return NULL;
+}
+
+static int AddLatency (Result *result, double latency)
+{
+	double *latencies;
+	size_t capacity;
+
+	if (result->numLatencies == result->latencyCapacity)
+	{
+		capacity = result->latencyCapacity ? 2 * result->latencyCapacity : 65536;
+		latencies = (double*)realloc(result->latencies, capacity * sizeof(double));
+		if (!latencies)
+			return -1;
+		result->latencies = latencies;
+		result->latencyCapacity = capacity;
+	}
+	result->latencies[result->numLatencies++] = latency;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Hand decoded vectors to the consumer. The ring is filled in place, the
+// locked queue gets a copy of the bytes like a CVI thread-safe queue. Waits
+// while the consumer is behind, so no vector is lost here.
+//-----------------------------------------------------------------------------
+static double *ReserveVectors (Handoff *handoff, unsigned int *count)
+{
+	static double vectors[MAX_VECTORS_PER_READ][FRAME_NUM_ELEMENTS];
+	double *space;
+
+	if (handoff->locked)
+	{
+		*count = MAX_VECTORS_PER_READ;
+		return vectors[0];
+	}
+
+	for (;;)
+	{
+		space = (double*)SpscRingReserve (&handoff->ring, count);
+		if (*count)
+			return space;
+		*count = MAX_VECTORS_PER_READ;
+		sched_yield (); // Spin, both handoffs wait alike
+	}
+}
+
+static void PublishVectors (Handoff *handoff, const double *vectors, unsigned int count)
+{
+	const unsigned char *bytes = (const unsigned char*)vectors;
+	size_t numBytes = count * FRAME_VECTOR_SIZE;
+	unsigned int numWritten;
+
+	if (!handoff->locked)
+	{
+		SpscRingPublish (&handoff->ring, count);
+		return;
+	}
+
+	while (numBytes > 0)
+	{
+		pthread_mutex_lock (&handoff->queueMutex);
+		numWritten = SpscRingWrite (&handoff->ring, bytes, (unsigned int)numBytes);
+		pthread_mutex_unlock (&handoff->queueMutex);
+		bytes += numWritten;
+		numBytes -= numWritten;
+		if (numBytes > 0)
+			sched_yield (); // Spin, both handoffs wait alike
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Receiver, the monitor's ComCallback loop without the UI
+//-----------------------------------------------------------------------------
+static void Receive (Link *link, Handoff *handoff)
+{
+	double magnitudes[MAX_VECTORS_PER_READ];
+	Acquisition acquisition;
+	Result *result = handoff->result;
+	struct pollfd pfd;
+	unsigned char *space;
+	double *vectors;
+	unsigned int numFree;
+	ssize_t numRead;
+	int numBytes;
+	int numValid;
+
+	AcquisitionInit (&acquisition);
+	pfd.fd = link->receiveFd;
+	pfd.events = POLLIN;
+
+	for (;;)
+	{
+		if (poll (&pfd, 1, DRAIN_TIMEOUT_MS) <= 0)
+		{
+			if (!AtomicLoad (&link->sending))
+				break; // Sender done and the link drained
+			continue;
+		}
+
+		if (handoff->locked)
+			pthread_mutex_lock (&handoff->receiveMutex);
+
+		space = FrameDecoderSpace (&acquisition.decoder, &numBytes);
+		numRead = read (link->receiveFd, space, numBytes);
+		if (numRead > 0)
+		{
+			FrameDecoderCommit (&acquisition.decoder, (int)numRead);
+
+			do
+			{
+				vectors = ReserveVectors (handoff, &numFree);
+				numValid = AcquisitionDecode (&acquisition, vectors, magnitudes, numFree);
+				if (numValid)
+					PublishVectors (handoff, vectors, numValid);
+			}
+			while (numValid == (int)numFree);
+		}
+
+		if (handoff->locked)
+			pthread_mutex_unlock (&handoff->receiveMutex);
+		if (numRead <= 0)
+			break;
+	}
+
+	// Frames lost in gaps, plus any lost after the last one received
+	result->received = acquisition.received;
+	result->lost = acquisition.missing + (link->vectorsSent - (acquisition.synced ? acquisition.nextSequence : 0));
+	result->checksumFailures = acquisition.decoder.framesDropped;
+	result->bytesSkipped = acquisition.decoder.bytesSkipped;
+}
+
+//-----------------------------------------------------------------------------
+// Take the next run of vectors off the handoff into the caller's buffer or,
+// for the ring, in place. Returns the number of vectors, 0 when empty.
+//-----------------------------------------------------------------------------
+static unsigned int TakeVectors (Handoff *handoff, double *buffer, const double **vectors, int draining)
+{
+	unsigned int numBytes;
+	unsigned int count = RING_VECTORS;
+
+	if (!handoff->locked)
+	{
+		*vectors = (const double*)SpscRingPeek (&handoff->ring, &count);
+		return count;
+	}
+
+	// Whole blocks only, the rest once the receiver is done
+	pthread_mutex_lock (&handoff->queueMutex);
+	numBytes = AtomicLoad (&handoff->ring.head) - handoff->ring.tail;
+	if (numBytes >= LOCKED_BLOCK)
+		numBytes = LOCKED_BLOCK;
+	else if (!draining)
+		numBytes = 0;
+	numBytes = SpscRingRead (&handoff->ring, buffer, numBytes);
+	pthread_mutex_unlock (&handoff->queueMutex);
+	*vectors = buffer;
+	return numBytes / FRAME_VECTOR_SIZE;
+}
+
+//-----------------------------------------------------------------------------
+// Consumer, the monitor's UI-thread processing: store the vectors and time
+// their arrival
+//-----------------------------------------------------------------------------
+static void *ConsumeThread (void *data)
+{
+	Handoff *handoff = (Handoff*)data;
+	Result *result = handoff->result;
+	double buffer[LOCKED_BLOCK / sizeof(double)];
+	const double *vectors;
+	SampleStore store;
+	double first = 0.0;
+	double now;
+	unsigned int count;
+	unsigned int i;
+	int draining;
+
+	SampleStoreInit (&store);
+	for (;;)
+	{
+		// Check for the end before taking, so the last take sees every vector
+		draining = !AtomicLoad (&handoff->receiving);
+		count = TakeVectors (handoff, buffer, &vectors, draining);
+		if (count == 0)
+		{
+			if (draining)
+				break;
+			sched_yield (); // Spin, both handoffs wait alike
+			continue;
+		}
+
+		if (SampleStoreAppend (&store, vectors, count) < 0)
+		{
+			handoff->error = -1;
+			break;
+		}
+
+		now = Now ();
+		if (!result->numLatencies)
+		{
+			first = now;
+			result->firstVectors = count;
+		}
+		result->seconds = now - first;
+
+		// Vectors of lost frames are interpolated, so are their send times
+		for (i = 0; i < count; i++)
+		{
+			if (AddLatency (result, now - handoff->link->start - vectors[i * FRAME_NUM_ELEMENTS] * SEND_TIME_UNIT) < 0)
+			{
+				handoff->error = -1;
+				break;
+			}
+		}
+		if (!handoff->locked)
+			SpscRingConsume (&handoff->ring, count);
+		if (handoff->error)
+			break;
+	}
+
+	SampleStoreFree (&store);
+	return NULL;
+}
+
+static int CompareDoubles (const void *a, const void *b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+
+	return (x > y) - (x < y);
+}
+
+static double Percentile (const Result *result, double fraction)
+{
+	size_t index;
+
+	if (!result->numLatencies)
+		return 0.0;
+	index = (size_t)(fraction * (result->numLatencies - 1) + 0.5);
+	return result->latencies[index];
+}
+
+//-----------------------------------------------------------------------------
+// Run the link at one rate and print a line of results
+//-----------------------------------------------------------------------------
+static int RunRate (const char *transport, double rate, double duration, double corruption, int encoding, int blockSize, int locked)
+{
+	Link link;
+	Result result;
+	Handoff handoff;
+	pthread_t sender;
+	pthread_t consumer;
+	int error;
+
+	memset(&link, 0, sizeof(link));
+	memset(&result, 0, sizeof(result));
+	memset(&handoff, 0, sizeof(handoff));
+	if (OpenTransport (transport, &link.sendFd, &link.receiveFd) < 0)
+	{
+		fprintf (stderr, "Failed to open a %s link.\n", transport);
+		return -1;
+	}
+	link.rate = rate;
+	link.duration = duration;
+	link.corruption = corruption;
+	link.encoding = encoding;
+	link.blockSize = blockSize;
+	link.start = Now ();
+	AtomicStore (&link.sending, 1);
+
+	handoff.locked = locked;
+	handoff.link = &link;
+	handoff.result = &result;
+	if (locked)
+		error = SpscRingInit (&handoff.ring, LOCKED_QUEUE_BYTES, 1);
+	else
+		error = SpscRingInit (&handoff.ring, RING_VECTORS, FRAME_VECTOR_SIZE);
+	if (error < 0)
+	{
+		fprintf (stderr, "Out of memory.\n");
+		return -1;
+	}
+	pthread_mutex_init (&handoff.queueMutex, NULL);
+	pthread_mutex_init (&handoff.receiveMutex, NULL);
+	AtomicStore (&handoff.receiving, 1);
+
+	if (pthread_create (&consumer, NULL, ConsumeThread, &handoff) != 0)
+		return -1;
+	if (pthread_create (&sender, NULL, SendThread, &link) != 0)
+		return -1;
+	Receive (&link, &handoff);
+	AtomicStore (&handoff.receiving, 0);
+	pthread_join (consumer, NULL);
+	pthread_join (sender, NULL);
+	close (link.sendFd);
+	close (link.receiveFd);
+	pthread_mutex_destroy (&handoff.queueMutex);
+	pthread_mutex_destroy (&handoff.receiveMutex);
+	SpscRingFree (&handoff.ring);
+
+	if (handoff.error < 0)
+	{
+		fprintf (stderr, "Out of memory.\n");
+		free(result.latencies);
+		return -1;
+	}
+
+	// Vectors arrive in bursts, the first one came in before the seconds started
+	qsort (result.latencies, result.numLatencies, sizeof(double), CompareDoubles);
+	printf ("%10.0f %10lu %12.0f %10u %10lu %10.1f %10.1f %10.1f %10.1f\n",
+			rate, link.vectorsSent,
+			result.seconds > 0 ? (result.received - result.firstVectors) / result.seconds : 0.0,
+			result.checksumFailures, result.lost,
+			Percentile (&result, 0.50) * 1e6, Percentile (&result, 0.99) * 1e6,
+			Percentile (&result, 0.999) * 1e6, Percentile (&result, 1.0) * 1e6);
+	fflush (stdout);
+	free(result.latencies);
+	return 0;
+}
+
+int main (int argc, char *argv[])
+{
+	double rates[MAX_RATES] = { 1000, 10000, 50000, 100000, 200000, 500000, 0 };
+	int numRates = 7;
+	const char *transport = "pty";
+	double duration = 2.0;
+	double corruption = 0.0;
+	int encoding = FRAME_TYPE_FIXED24;
+	int blockSize = 16;
+	int frameSize;
+	int locked = 0;
+	char *token;
+	int option;
+	int i;
+
+	while ((option = getopt (argc, argv, "t:d:r:e:f:n:q:")) != -1)
+	{
+		switch (option)
+		{
+			case 't':
+				transport = optarg;
+				break;
+			case 'd':
+				duration = atof (optarg);
+				break;
+			case 'r':
+				for (numRates = 0, token = strtok (optarg, ","); token && numRates < MAX_RATES; token = strtok (NULL, ","))
+					rates[numRates++] = atof (token);
+				break;
+			case 'e':
+				corruption = atof (optarg);
+				break;
+			case 'f':
+				encoding = strcmp (optarg, "float64") == 0 ? FRAME_TYPE_FLOAT64 : FRAME_TYPE_FIXED24;
+				break;
+			case 'n':
+				blockSize = atoi (optarg);
+				if (blockSize < 1 || blockSize > FRAME_MAX_VECTORS)
+					blockSize = FRAME_MAX_VECTORS;
+				break;
+			case 'q':
+				locked = strcmp (optarg, "locked") == 0;
+				break;
+			default:
+				fprintf (stderr, "Usage: %s [-t pty|socketpair] [-d seconds] [-r rate,rate,...] [-e corruption] [-f fixed|float64] [-n vectors] [-q spsc|locked]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	frameSize = blockSize > 1 ? FrameSize (FRAME_TYPE_BLOCK | encoding, blockSize) : FrameSize (encoding, 1);
+	printf ("Transport %s, %.1f s per rate, %d vectors in %d-byte frames, %s handoff\n", transport, duration,
+			blockSize, frameSize, locked ? "locked" : "spsc");
+	printf ("%10s %10s %12s %10s %10s %10s %10s %10s %10s\n", "target/s", "sent", "received/s",
+			"checksum", "lost", "p50 us", "p99 us", "p99.9 us", "max us");
+	for (i = 0; i < numRates; i++)
+		if (RunRate (transport, rates[i], duration, corruption, encoding, blockSize, locked) < 0)
+			return 1;
+	return 0;
+}
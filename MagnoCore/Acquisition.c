@@ -0,0 +1,164 @@
+//==============================================================================
+// Title:		UI-free receive path of the monitor.
+// Description:	See Acquisition.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include "Acquisition.h"
+
+void MagnitudeStatsInit (MagnitudeStats *stats)
+{
+	stats->min = 0.0;
+	stats->max = 0.0;
+	stats->count = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Calculate the magnitude of interleaved x, y, z vectors and update the
+// running minimum and maximum
+//-----------------------------------------------------------------------------
+void MagnitudeCompute (MagnitudeStats *stats, const double *vectors, int numVectors, double *magnitudes)
+{
+	const double *v;
+	double magnitude;
+	int i;
+
+	for (i = 0; i < numVectors; i++)
+	{
+		v = vectors + i * ACQUISITION_NUM_ELEMENTS;
+		magnitude = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		magnitudes[i] = magnitude;
+
+		if (magnitude < stats->min || stats->count == 0)
+			stats->min = magnitude;
+		if (magnitude > stats->max || stats->count == 0)
+			stats->max = magnitude;
+		stats->count++;
+	}
+}
+
+void AcquisitionInit (Acquisition *acquisition)
+{
+	memset(acquisition, 0, sizeof(*acquisition));
+	FrameDecoderInit (&acquisition->decoder);
+	MagnitudeStatsInit (&acquisition->stats);
+}
+
+//-----------------------------------------------------------------------------
+// Start measuring the rate again from this frame
+//-----------------------------------------------------------------------------
+static void RestartGrid (Acquisition *acquisition, const FrameSample *sample)
+{
+	acquisition->firstSequence = sample->sequence;
+	acquisition->firstTimestamp = sample->timestamp;
+}
+
+//-----------------------------------------------------------------------------
+// Check a received frame against the expected sequence number and hold it
+// back until the vectors lost before it have been interpolated
+//-----------------------------------------------------------------------------
+static void AcceptFrame (Acquisition *acquisition, const FrameSample *sample)
+{
+	unsigned int gap;
+
+	acquisition->received++;
+	if (!acquisition->synced)
+	{
+		acquisition->synced = 1;
+		acquisition->nextSequence = sample->sequence;
+		RestartGrid (acquisition, sample);
+	}
+
+	// Unsigned difference, correct across the wrap of the sequence number
+	gap = sample->sequence - acquisition->nextSequence;
+	if (gap >= 0x80000000u || gap > ACQUISITION_MAX_GAP_FILL)
+	{
+		// The sender restarted or too much was lost to bridge
+		if (gap < 0x80000000u)
+		{
+			acquisition->missing += gap;
+			acquisition->gaps++;
+		}
+		acquisition->restarts++;
+		RestartGrid (acquisition, sample);
+	}
+	else if (gap > 0)
+	{
+		acquisition->missing += gap;
+		acquisition->gaps++;
+		acquisition->interpolated += gap;
+		acquisition->fillTotal = acquisition->fillRemaining = gap;
+		memcpy(acquisition->fillFrom, acquisition->last, sizeof(acquisition->last));
+	}
+
+	acquisition->nextSequence = sample->sequence + 1;
+	acquisition->lastSequence = sample->sequence;
+	acquisition->lastTimestamp = sample->timestamp;
+	acquisition->pending = *sample;
+	acquisition->hasPending = 1;
+}
+
+//-----------------------------------------------------------------------------
+// Decode up to maxVectors vectors from the bytes committed to the decoder
+// into interleaved vectors and their magnitudes. Corrupted frames are skipped
+// by the decoder; vectors of lost frames are interpolated. Returns the number
+// of vectors output.
+//-----------------------------------------------------------------------------
+int AcquisitionDecode (Acquisition *acquisition, double *vectors, double *magnitudes, int maxVectors)
+{
+	FrameSample sample;
+	double *vector;
+	double fraction;
+	int numValid = 0;
+	int i;
+
+	while (numValid < maxVectors)
+	{
+		vector = vectors + numValid * ACQUISITION_NUM_ELEMENTS;
+
+		if (acquisition->fillRemaining > 0)
+		{
+			// Bridge the gap between the last vector and the pending frame
+			fraction = (double)(acquisition->fillTotal - acquisition->fillRemaining + 1) / (acquisition->fillTotal + 1);
+			for (i = 0; i < ACQUISITION_NUM_ELEMENTS; i++)
+				vector[i] = acquisition->fillFrom[i] + fraction * (acquisition->pending.vector[i] - acquisition->fillFrom[i]);
+			acquisition->fillRemaining--;
+		}
+		else if (acquisition->hasPending)
+		{
+			memcpy(vector, acquisition->pending.vector, sizeof(acquisition->pending.vector));
+			acquisition->hasPending = 0;
+		}
+		else
+		{
+			if (!FrameDecoderNext (&acquisition->decoder, &sample))
+				break;
+			AcceptFrame (acquisition, &sample);
+			continue;
+		}
+
+		memcpy(acquisition->last, vector, sizeof(acquisition->last));
+		numValid++;
+	}
+
+	MagnitudeCompute (&acquisition->stats, vectors, numValid, magnitudes);
+	return numValid;
+}
+
+//-----------------------------------------------------------------------------
+// Sampling rate measured from the sender's timestamps, 0 until they span
+// ACQUISITION_MIN_RATE_SPAN seconds and ACQUISITION_MIN_RATE_VECTORS vectors
+//-----------------------------------------------------------------------------
+double AcquisitionRate (const Acquisition *acquisition)
+{
+	double span = (acquisition->lastTimestamp - acquisition->firstTimestamp) * FRAME_TIMESTAMP_UNIT;
+	unsigned int numVectors = acquisition->lastSequence - acquisition->firstSequence;
+
+	if (!acquisition->synced || span < ACQUISITION_MIN_RATE_SPAN || numVectors < ACQUISITION_MIN_RATE_VECTORS)
+		return 0.0;
+	return numVectors / span;
+}
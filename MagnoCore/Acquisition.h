@@ -0,0 +1,81 @@
+//==============================================================================
+// Title:		UI-free receive path of the monitor.
+// Description:	Turns the received byte stream into x, y, z vectors and their
+//				magnitudes, and keeps the running magnitude extremes. The
+//				LabWindows/CVI frontend only moves bytes in and results to the
+//				screen, so the same code runs headless for benchmarks.
+//				Vectors are output on the sender's sequence grid: up to a few
+//				of the largest block frames lost in a row are counted and
+//				bridged by linear interpolation, so vector n is sample n of
+//				the sender and the time axis stays true. Longer runs are not
+//				made up, the grid restarts after them. Every interpolated
+//				vector is counted. The sampling rate is measured from the
+//				sender's timestamps instead of trusted from the configuration,
+//				once they span enough time and vectors to be reliable.
+//==============================================================================
+
+#ifndef ACQUISITION_H
+#define ACQUISITION_H
+
+#include "MagnoFrame.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define ACQUISITION_NUM_ELEMENTS	FRAME_NUM_ELEMENTS 	// x, y, z vector
+#define ACQUISITION_MAX_GAP_FILL	(4 * FRAME_MAX_VECTORS) 	// Longer gaps restart the grid instead
+#define ACQUISITION_MIN_RATE_SPAN	4.0 	// Seconds of timestamps needed to measure the rate
+#define ACQUISITION_MIN_RATE_VECTORS	(4 * FRAME_MAX_VECTORS) 	// And vectors, several of the largest bursts
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	double min;						// Smallest magnitude seen
+	double max;						// Largest magnitude seen
+	unsigned long count;			// Magnitudes seen
+} MagnitudeStats;
+
+typedef struct
+{
+	FrameDecoder decoder;
+	MagnitudeStats stats;
+	int synced;								// A first frame has been received
+	unsigned int nextSequence;				// Sequence number expected next
+	unsigned int firstSequence;				// Start of the rate measurement
+	unsigned int lastSequence;
+	unsigned long long firstTimestamp;
+	unsigned long long lastTimestamp;
+	double last[ACQUISITION_NUM_ELEMENTS];	// Last vector output
+	FrameSample pending;					// Frame received after a gap
+	int hasPending;
+	unsigned int fillTotal;					// Vectors interpolated before pending
+	unsigned int fillRemaining;
+	double fillFrom[ACQUISITION_NUM_ELEMENTS];
+	unsigned long received;					// Frames received
+	unsigned long missing;					// Frames lost in gaps
+	unsigned long gaps;						// Runs of lost frames
+	unsigned long interpolated;				// Vectors output for lost frames
+	unsigned long restarts;					// Sequence jumps the grid restarted on
+} Acquisition;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+void MagnitudeStatsInit (MagnitudeStats *stats);
+void MagnitudeCompute (MagnitudeStats *stats, const double *vectors, int numVectors, double *magnitudes);
+
+void AcquisitionInit (Acquisition *acquisition);
+int AcquisitionDecode (Acquisition *acquisition, double *vectors, double *magnitudes, int maxVectors);
+double AcquisitionRate (const Acquisition *acquisition);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* ACQUISITION_H */
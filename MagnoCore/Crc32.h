@@ -0,0 +1,28 @@
+//==============================================================================
+// Title:		CRC-32 (IEEE 802.3) checksums.
+// Description:	The reflected 0xEDB88320 polynomial of Ethernet and zip, with
+//				an all-ones preset and final inversion. Eight bytes are folded
+//				per step with precomputed tables (slice-by-8), so a block
+//				frame costs a fraction of a byte-wise CRC. Pass 0 to start a
+//				checksum, or the previous result to continue it.
+//==============================================================================
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+unsigned int Crc32 (unsigned int crc, const unsigned char *data, size_t size);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* CRC32_H */
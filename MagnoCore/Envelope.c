@@ -0,0 +1,88 @@
+//==============================================================================
+// Title:		Min/max envelope decimation for strip charts.
+// Description:	See Envelope.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include "Envelope.h"
+
+//-----------------------------------------------------------------------------
+// Samples per bucket that fit a screen of samplesPerScreen into numColumns
+// min/max pairs. Returns 1 when the samples fit as they are: decimating to
+// pairs only pays once there are more than two samples per column.
+//-----------------------------------------------------------------------------
+size_t EnvelopeBucketSize (double samplesPerScreen, int numColumns)
+{
+	if (numColumns < 1 || samplesPerScreen <= 2.0 * numColumns)
+		return 1;
+	return (size_t)ceil(samplesPerScreen / numColumns);
+}
+
+void EnvelopeInit (Envelope *envelope, size_t bucketSize)
+{
+	memset(envelope, 0, sizeof(*envelope));
+	envelope->bucketSize = bucketSize ? bucketSize : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Reduce numSamples more samples into points, two per bucket completed. A
+// partial bucket carries over to the next feed. points must hold
+// ENVELOPE_MAX_POINTS(numSamples). Returns the number of points written.
+//-----------------------------------------------------------------------------
+size_t EnvelopeFeed (Envelope *envelope, const double *samples, size_t numSamples, double *points)
+{
+	size_t bucketSize = envelope->bucketSize;
+	size_t numPoints = 0;
+	size_t i;
+	double value;
+
+	if (bucketSize == 1)
+	{
+		memcpy(points, samples, numSamples * sizeof(double));
+		return numSamples;
+	}
+
+	for (i = 0; i < numSamples; i++)
+	{
+		value = samples[i];
+		if (envelope->filled == 0)
+		{
+			envelope->min = value;
+			envelope->max = value;
+			envelope->minFirst = 1;
+		}
+		else if (value < envelope->min)
+		{
+			envelope->min = value;
+			envelope->minFirst = 0;
+		}
+		else if (value > envelope->max)
+		{
+			envelope->max = value;
+			envelope->minFirst = 1;
+		}
+
+		if (++envelope->filled == bucketSize)
+			numPoints += EnvelopeFlush (envelope, points + numPoints);
+	}
+	return numPoints;
+}
+
+//-----------------------------------------------------------------------------
+// Emit the open bucket early, such as before the bucket size changes.
+// Returns the number of points written, 0 or 2.
+//-----------------------------------------------------------------------------
+size_t EnvelopeFlush (Envelope *envelope, double *points)
+{
+	if (envelope->filled == 0)
+		return 0;
+
+	points[0] = envelope->minFirst ? envelope->min : envelope->max;
+	points[1] = envelope->minFirst ? envelope->max : envelope->min;
+	envelope->filled = 0;
+	return 2;
+}
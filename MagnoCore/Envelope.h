@@ -0,0 +1,50 @@
+//==============================================================================
+// Title:		Min/max envelope decimation for strip charts.
+// Description:	Consecutive samples are grouped into buckets and each full
+//				bucket is reduced to its minimum and maximum, emitted in the
+//				order they occurred. With one bucket per pixel column the
+//				chart draws the same vertical extent as the raw samples,
+//				spikes included, while the number of plotted points stays
+//				bounded by twice the plot width whatever the sampling rate
+//				or window length. A bucket size of 1 passes samples through.
+//==============================================================================
+
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define ENVELOPE_MAX_POINTS(numSamples)	((numSamples) + 2) 	// Points one feed can emit at most
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	size_t bucketSize;			// Samples per min/max pair
+	size_t filled;				// Samples in the open bucket
+	double min;
+	double max;
+	int minFirst;				// The minimum came before the maximum
+} Envelope;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+size_t EnvelopeBucketSize (double samplesPerScreen, int numColumns);
+void EnvelopeInit (Envelope *envelope, size_t bucketSize);
+size_t EnvelopeFeed (Envelope *envelope, const double *samples, size_t numSamples, double *points);
+size_t EnvelopeFlush (Envelope *envelope, double *points);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* ENVELOPE_H */
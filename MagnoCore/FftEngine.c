@@ -0,0 +1,199 @@
+//==============================================================================
+// Title:		Spectrum of the recorded x, y, z vectors.
+// Description:	See FftEngine.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FftEngine.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define ALIGN_UP(n)		(((n) + FFT_ENGINE_ALIGNMENT - 1) & ~(size_t)(FFT_ENGINE_ALIGNMENT - 1))
+
+//-----------------------------------------------------------------------------
+// Make sure the workspace holds at least length samples per axis.
+// Returns -1 when out of memory.
+//-----------------------------------------------------------------------------
+int FftEngineReserve (FftEngine *engine, size_t length)
+{
+	size_t arraySize;
+	char *base;
+	void *memory;
+	int i;
+
+	if (length <= engine->capacity)
+		return 0; // Reuse the current workspace
+
+	// Six transform arrays plus magnitude and frequency, each on its own cache line
+	arraySize = ALIGN_UP(length * sizeof(double));
+	memory = malloc((2 * FFT_ENGINE_NUM_AXES + 2) * arraySize + FFT_ENGINE_ALIGNMENT);
+	if (!memory)
+		return -1;
+
+	free(engine->memory);
+	engine->memory = memory;
+	engine->capacity = length;
+
+	base = (char*)ALIGN_UP((size_t)memory);
+	for (i = 0; i < FFT_ENGINE_NUM_AXES; i++)
+	{
+		engine->real[i] = (double*)(base + (2 * i) * arraySize);
+		engine->imag[i] = (double*)(base + (2 * i + 1) * arraySize);
+	}
+	engine->magnitude = (double*)(base + (2 * FFT_ENGINE_NUM_AXES) * arraySize);
+	engine->frequency = (double*)(base + (2 * FFT_ENGINE_NUM_AXES + 1) * arraySize);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Calculate the magnitude spectrum of the whole record. Returns the number
+// of bins in magnitude and frequency, or -1 when out of memory.
+//-----------------------------------------------------------------------------
+int FftEngineCompute (FftEngine *engine, const SampleStore *store, double fs, WindowType window)
+{
+	const WindowTable *table;
+	double *real;
+	size_t n = store->count;
+	size_t i;
+	double df;
+	double sum;
+	int axis;
+
+	engine->numSegments = 0;
+	if (FftEngineReserve (engine, n) < 0 || FftPlanPrepare (&engine->plan, n) < 0)
+		return -1;
+
+	table = WindowCacheGet (&engine->windows, window, n);
+	if (!table)
+		return -1;
+
+	for (axis = 0; axis < FFT_ENGINE_NUM_AXES; axis++)
+	{
+		real = engine->real[axis];
+
+		// Gather a contiguous array of the axis from the sample store
+		SampleStoreCopyAxis (store, axis, 0, n, real);
+
+		// Apply window to the copy to reduce spectral leakage
+		for (i = 0; i < n; i++)
+			real[i] *= table->coefficients[i];
+
+		// Calculate the FFT
+		FftPlanExecute (&engine->plan, real, engine->imag[axis]);
+	}
+
+	df = fs / n; // Calculate frequency resolution
+	for (i = 0; i <= n / 2; i++)
+	{
+		// Combine the magnitudes of the three axes
+		for (axis = 0, sum = 0.0; axis < FFT_ENGINE_NUM_AXES; axis++)
+			sum += engine->real[axis][i] * engine->real[axis][i] + engine->imag[axis][i] * engine->imag[axis][i];
+		engine->magnitude[i] = sqrt(sum);
+
+		// Normalize to amplitudes, correcting for the window's coherent gain.
+		// The DC bin has no mirror image.
+		engine->magnitude[i] /= i ? table->sum / 2.0 : table->sum;
+
+		// Calculate frequencies
+		engine->frequency[i] = i * df;
+	}
+	engine->numSegments = 1;
+	return (int)(n / 2 + 1);
+}
+
+//-----------------------------------------------------------------------------
+// Largest power-of-two segment that still gives about WELCH_MIN_SEGMENTS
+// overlapping segments, or 0 when the record is too short
+//-----------------------------------------------------------------------------
+static size_t WelchSegmentLength (size_t n)
+{
+	size_t segment = WELCH_MAX_SEGMENT;
+
+	while (segment > WELCH_MIN_SEGMENT && segment * (WELCH_MIN_SEGMENTS + 1) / 2 > n)
+		segment /= 2;
+	return segment <= n ? segment : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Estimate the one-sided power spectral density of the x, y, z field with
+// Welch's method. magnitude receives the square root of the summed axis
+// densities in nT/sqrt(Hz) and numSegments the number of periodograms
+// averaged. Returns the number of bins, 0 when the record is shorter than
+// WELCH_MIN_SEGMENT, or -1 when out of memory.
+//-----------------------------------------------------------------------------
+int FftEngineWelch (FftEngine *engine, const SampleStore *store, double fs, WindowType window)
+{
+	const WindowTable *table;
+	double *real;
+	double *imag;
+	size_t segment = WelchSegmentLength (store->count);
+	size_t hop = segment / 2;
+	size_t numSegments;
+	size_t numBins = segment / 2 + 1;
+	size_t s, i;
+	double mean;
+	double scale;
+	int axis;
+
+	engine->numSegments = 0;
+	if (!segment)
+		return 0;
+	numSegments = (store->count - segment) / hop + 1;
+
+	if (FftEngineReserve (engine, segment) < 0 || FftPlanPrepare (&engine->plan, segment) < 0)
+		return -1;
+
+	table = WindowCacheGet (&engine->windows, window, segment);
+	if (!table)
+		return -1;
+
+	memset(engine->magnitude, 0, numBins * sizeof(double));
+	for (s = 0; s < numSegments; s++)
+	{
+		for (axis = 0; axis < FFT_ENGINE_NUM_AXES; axis++)
+		{
+			real = engine->real[axis];
+			imag = engine->imag[axis];
+			SampleStoreCopyAxis (store, axis, s * hop, segment, real);
+
+			// Remove the segment mean so the static field doesn't leak, then window
+			for (i = 0, mean = 0.0; i < segment; i++)
+				mean += real[i];
+			mean /= segment;
+			for (i = 0; i < segment; i++)
+				real[i] = (real[i] - mean) * table->coefficients[i];
+
+			FftPlanExecute (&engine->plan, real, imag);
+
+			// Accumulate the periodograms in magnitude
+			for (i = 0; i < numBins; i++)
+				engine->magnitude[i] += real[i] * real[i] + imag[i] * imag[i];
+		}
+	}
+
+	// Average and scale to a density, folding the negative frequencies
+	// into every bin except DC and Nyquist
+	scale = 1.0 / (fs * table->sumOfSquares * numSegments);
+	for (i = 0; i < numBins; i++)
+	{
+		engine->magnitude[i] *= (i == 0 || i == numBins - 1) ? scale : 2.0 * scale;
+		engine->magnitude[i] = sqrt(engine->magnitude[i]);
+		engine->frequency[i] = i * fs / segment;
+	}
+	engine->numSegments = numSegments;
+	return (int)numBins;
+}
+
+void FftEngineFree (FftEngine *engine)
+{
+	WindowCacheFree (&engine->windows);
+	FftPlanFree (&engine->plan);
+	free(engine->memory);
+	memset(engine, 0, sizeof(*engine));
+}
@@ -0,0 +1,69 @@
+//==============================================================================
+// Title:		Spectrum of the recorded x, y, z vectors.
+// Description:	The engine owns one aligned heap workspace for the real and
+//				imaginary parts of the three axes and the resulting spectrum.
+//				The workspace is sized once for the capture length and reused
+//				when the same or a shorter record is transformed again. The
+//				window is applied to the workspace copy, never to the recorded
+//				data, using coefficient tables cached by the engine.
+//				Besides the single whole-record spectrum, the engine estimates
+//				the power spectral density with Welch's method: the record is
+//				split into 50% overlapping power-of-two segments whose
+//				periodograms are averaged. A short record gets fewer than
+//				WELCH_MIN_SEGMENTS averages; numSegments tells how many.
+//				The transforms use the portable MagnoFft, so the engine builds
+//				without LabWindows/CVI.
+//==============================================================================
+
+#ifndef FFT_ENGINE_H
+#define FFT_ENGINE_H
+
+#include <stddef.h>
+#include "SampleStore.h"
+#include "WindowTable.h"
+#include "MagnoFft.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define FFT_ENGINE_NUM_AXES		SAMPLE_STORE_NUM_ELEMENTS
+#define FFT_ENGINE_ALIGNMENT	64 		// Cache line
+#define WELCH_MIN_SEGMENT		16
+#define WELCH_MAX_SEGMENT		65536
+#define WELCH_MIN_SEGMENTS		8 		// Averages aimed for when picking the segment length
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	void *memory;							// Single allocation backing the arrays
+	size_t capacity;						// Samples the workspace is sized for
+	double *real[FFT_ENGINE_NUM_AXES];
+	double *imag[FFT_ENGINE_NUM_AXES];
+	double *magnitude;						// Magnitude of the x, y, z spectra, or their
+											// amplitude spectral density for Welch
+	double *frequency;						// Frequency of each magnitude bin
+	size_t numSegments;						// Spectra averaged into magnitude, 1 for the
+											// whole record, 0 when nothing was computed
+	WindowCache windows;
+	FftPlan plan;							// Transform of the last length used
+} FftEngine;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int FftEngineReserve (FftEngine *engine, size_t length);
+int FftEngineCompute (FftEngine *engine, const SampleStore *store, double fs, WindowType window);
+int FftEngineWelch (FftEngine *engine, const SampleStore *store, double fs, WindowType window);
+void FftEngineFree (FftEngine *engine);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* FFT_ENGINE_H */
@@ -0,0 +1,246 @@
+//==============================================================================
+// Title:		Synthetic x, y, z magnetic field generator.
+// Description:	See FieldGenerator.h. White noise is the sum of four uniform
+//				variates, close enough to Gaussian for testing and much
+//				cheaper. 1/f noise is white noise through Paul Kellet's
+//				three-pole pinking filter, which follows 1/f to within about
+//				half a dB over the three decades below fs / 2.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include "FieldGenerator.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define PI				3.14159265358979323846
+#define RANDOM_SEED		0x9E3779B97F4A7C15ULL
+#define PINK_GAIN		0.33568 	// Scales the pinking filter to unit rms, 1 / sqrt(8.8745)
+
+//-----------------------------------------------------------------------------
+// A quiet field like the one in Data.txt, with a 1 Hz tone on z and 50 Hz
+// mains interference
+//-----------------------------------------------------------------------------
+void GeneratorDefaultModel (GeneratorModel *model)
+{
+	memset(model, 0, sizeof(*model));
+	model->offset[0] = 20527.0;
+	model->offset[1] = 2882.0;
+	model->offset[2] = 47083.0;
+	model->numTones = 1;
+	model->tones[0].frequency = 1.0;
+	model->tones[0].amplitude[2] = 10.0;
+	model->mainsFrequency = 50.0;
+	model->mainsAmplitude[0] = model->mainsAmplitude[1] = model->mainsAmplitude[2] = 2.0;
+	model->numHarmonics = 3;
+	model->whiteNoise = 0.5;
+}
+
+//-----------------------------------------------------------------------------
+// Start generating from time 0 with fresh noise
+//-----------------------------------------------------------------------------
+void GeneratorInit (FieldGenerator *generator, const GeneratorModel *model, double fs)
+{
+	GeneratorModel start = *model; // May be the generator's own model
+
+	memset(generator, 0, sizeof(*generator));
+	generator->random = RANDOM_SEED;
+	GeneratorSetModel (generator, &start, fs);
+}
+
+//-----------------------------------------------------------------------------
+// Frequency of a phase accumulator: tone source, or mains harmonic
+// source - GENERATOR_MAX_TONES + 1. 0 when the model doesn't use it.
+//-----------------------------------------------------------------------------
+static double SourceFrequency (const GeneratorModel *model, int source)
+{
+	if (source < GENERATOR_MAX_TONES)
+		return source < model->numTones ? model->tones[source].frequency : 0.0;
+	source -= GENERATOR_MAX_TONES - 1;
+	return source <= model->numHarmonics ? source * model->mainsFrequency : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+// Set up an oscillator for a source, starting from its accumulated phase
+//-----------------------------------------------------------------------------
+static void SetOscillator (FieldGenerator *generator, Oscillator *oscillator, int source,
+						   const double *amplitude, double scale)
+{
+	double step = 2.0 * PI * SourceFrequency (&generator->model, source) / generator->fs;
+	int i;
+
+	for (i = 0; i <= GENERATOR_BLOCK; i++)
+	{
+		oscillator->cosTable[i] = cos(i * step);
+		oscillator->sinTable[i] = sin(i * step);
+	}
+	oscillator->cosPhase = cos(2.0 * PI * generator->phase[source]);
+	oscillator->sinPhase = sin(2.0 * PI * generator->phase[source]);
+	for (i = 0; i < GENERATOR_NUM_ELEMENTS; i++)
+		oscillator->amplitude[i] = amplitude[i] * scale;
+}
+
+//-----------------------------------------------------------------------------
+// Change the model or the rate. Every sinusoid goes on from the phase it had
+// reached. Tones and harmonics above fs / 2 are left out.
+//-----------------------------------------------------------------------------
+void GeneratorSetModel (FieldGenerator *generator, const GeneratorModel *model, double fs)
+{
+	int i;
+
+	generator->model = *model;
+	generator->fs = fs > 0 ? fs : 1.0;
+	generator->numOscillators = 0;
+
+	for (i = 0; i < model->numTones && i < GENERATOR_MAX_TONES; i++)
+		if (model->tones[i].frequency < generator->fs / 2)
+			SetOscillator (generator, &generator->oscillators[generator->numOscillators++],
+						   i, model->tones[i].amplitude, 1.0);
+
+	for (i = 1; model->mainsFrequency > 0 && i <= model->numHarmonics && i <= GENERATOR_MAX_HARMONICS; i++)
+		if (i * model->mainsFrequency < generator->fs / 2)
+			SetOscillator (generator, &generator->oscillators[generator->numOscillators++],
+						   GENERATOR_MAX_TONES + i - 1, model->mainsAmplitude, 1.0 / i);
+
+	generator->stepPeriod = (unsigned long long)floor(model->stepInterval * generator->fs + 0.5);
+}
+
+//-----------------------------------------------------------------------------
+// Uniform in [0, 1) from a xorshift64* generator
+//-----------------------------------------------------------------------------
+static double Uniform (unsigned long long *state)
+{
+	unsigned long long x = *state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+	return (double)((x * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//-----------------------------------------------------------------------------
+// Zero mean, unit variance, nearly Gaussian
+//-----------------------------------------------------------------------------
+static double Gaussian (unsigned long long *state)
+{
+	double sum = Uniform (state) + Uniform (state) + Uniform (state) + Uniform (state);
+
+	return (sum - 2.0) * 1.7320508075688772; // sqrt(12 / 4)
+}
+
+//-----------------------------------------------------------------------------
+// Synthesize numSamples vectors into the per-axis block
+//-----------------------------------------------------------------------------
+static void FillBlock (FieldGenerator *generator, int numSamples)
+{
+	const GeneratorModel *model = &generator->model;
+	Oscillator *oscillator;
+	double *block;
+	double *pink;
+	double level;
+	double white;
+	double pinkWhite;
+	double cosPhase, sinPhase, norm;
+	unsigned long long untilStep;
+	int axis;
+	int i, k, n;
+
+	// DC and steps, constant between step events
+	for (axis = 0; axis < GENERATOR_NUM_ELEMENTS; axis++)
+	{
+		block = generator->block[axis];
+		for (i = 0; i < numSamples; i += n)
+		{
+			n = numSamples - i;
+			if (generator->stepPeriod)
+			{
+				untilStep = generator->stepPeriod - (generator->index + i) % generator->stepPeriod;
+				if (untilStep < (unsigned long long)n)
+					n = (int)untilStep;
+			}
+			level = model->offset[axis];
+			if (generator->stepPeriod && ((generator->index + i) / generator->stepPeriod) % 2)
+				level += model->step[axis];
+			for (k = i; k < i + n; k++)
+				block[k] = level;
+		}
+	}
+
+	// Sinusoids: sin(phase + i w) = sin(phase) cos(i w) + cos(phase) sin(i w)
+	for (k = 0; k < generator->numOscillators; k++)
+	{
+		oscillator = &generator->oscillators[k];
+		for (axis = 0; axis < GENERATOR_NUM_ELEMENTS; axis++)
+		{
+			double sinAmplitude = oscillator->amplitude[axis] * oscillator->sinPhase;
+			double cosAmplitude = oscillator->amplitude[axis] * oscillator->cosPhase;
+
+			if (oscillator->amplitude[axis] == 0)
+				continue;
+			block = generator->block[axis];
+			for (i = 0; i < numSamples; i++)
+				block[i] += sinAmplitude * oscillator->cosTable[i] + cosAmplitude * oscillator->sinTable[i];
+		}
+
+		// Rotate the phase past the block and keep it on the unit circle
+		cosPhase = oscillator->cosPhase * oscillator->cosTable[numSamples] - oscillator->sinPhase * oscillator->sinTable[numSamples];
+		sinPhase = oscillator->sinPhase * oscillator->cosTable[numSamples] + oscillator->cosPhase * oscillator->sinTable[numSamples];
+		norm = 1.0 / sqrt(cosPhase * cosPhase + sinPhase * sinPhase);
+		oscillator->cosPhase = cosPhase * norm;
+		oscillator->sinPhase = sinPhase * norm;
+	}
+
+	// Keep the phase of every source, played or not, for the next model change
+	for (k = 0; k < GENERATOR_MAX_OSCILLATORS; k++)
+	{
+		generator->phase[k] += SourceFrequency (model, k) * numSamples / generator->fs;
+		generator->phase[k] -= floor(generator->phase[k]);
+	}
+
+	// White and 1/f noise, each from its own draws so they are independent
+	if (model->whiteNoise > 0 || model->pinkNoise > 0)
+	{
+		for (axis = 0; axis < GENERATOR_NUM_ELEMENTS; axis++)
+		{
+			block = generator->block[axis];
+			pink = generator->pink[axis];
+			for (i = 0; i < numSamples; i++)
+			{
+				white = Gaussian (&generator->random);
+				pinkWhite = Gaussian (&generator->random);
+				pink[0] = 0.99765 * pink[0] + pinkWhite * 0.0990460;
+				pink[1] = 0.96300 * pink[1] + pinkWhite * 0.2965164;
+				pink[2] = 0.57000 * pink[2] + pinkWhite * 1.0526913;
+				block[i] += model->whiteNoise * white
+							+ model->pinkNoise * PINK_GAIN * (pink[0] + pink[1] + pink[2] + pinkWhite * 0.1848);
+			}
+		}
+	}
+
+	generator->index += numSamples;
+}
+
+//-----------------------------------------------------------------------------
+// Generate the next numVectors interleaved x, y, z vectors
+//-----------------------------------------------------------------------------
+void GeneratorFill (FieldGenerator *generator, double *vectors, size_t numVectors)
+{
+	int numSamples;
+	int axis;
+	int i;
+
+	while (numVectors)
+	{
+		numSamples = numVectors < GENERATOR_BLOCK ? (int)numVectors : GENERATOR_BLOCK;
+		FillBlock (generator, numSamples);
+		for (i = 0; i < numSamples; i++)
+			for (axis = 0; axis < GENERATOR_NUM_ELEMENTS; axis++)
+				*vectors++ = generator->block[axis][i];
+		numVectors -= numSamples;
+	}
+}
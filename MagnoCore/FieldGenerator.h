@@ -0,0 +1,93 @@
+//==============================================================================
+// Title:		Synthetic x, y, z magnetic field generator.
+// Description:	Synthesizes a field with known content for testing the
+//				receiver: a DC offset, sinusoids, mains interference with its
+//				harmonics, white and 1/f noise, and step events. Vectors are
+//				produced a block at a time. Every sinusoid is evaluated from a
+//				table of cos(i w), sin(i w) over the block and its phase at the
+//				block start, so the inner loops have no dependency between
+//				samples and no transcendental calls, and the compiler can
+//				vectorize them. Every tone and mains harmonic keeps its own
+//				phase accumulator, so changing the model or fs keeps each
+//				sinusoid's phase continuous. The white and 1/f noise come from
+//				independent draws, so their densities add.
+//==============================================================================
+
+#ifndef FIELD_GENERATOR_H
+#define FIELD_GENERATOR_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define GENERATOR_NUM_ELEMENTS	3 		// x, y, z vector
+#define GENERATOR_MAX_TONES		4
+#define GENERATOR_MAX_HARMONICS	8 		// Mains fundamental and harmonics
+#define GENERATOR_BLOCK			256 	// Vectors synthesized per kernel pass
+#define GENERATOR_MAX_OSCILLATORS	(GENERATOR_MAX_TONES + GENERATOR_MAX_HARMONICS)
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	double frequency;							// Hz
+	double amplitude[GENERATOR_NUM_ELEMENTS];	// nT peak, per axis
+} GeneratorTone;
+
+typedef struct
+{
+	double offset[GENERATOR_NUM_ELEMENTS];		// DC field, nT
+	GeneratorTone tones[GENERATOR_MAX_TONES];
+	int numTones;
+	double mainsFrequency;						// Hz, 0 for none
+	double mainsAmplitude[GENERATOR_NUM_ELEMENTS];	// nT peak of the fundamental, harmonic k has 1/k of it
+	int numHarmonics;							// Fundamental included
+	double whiteNoise;							// nT rms, per axis
+	double pinkNoise;							// nT rms of the 1/f noise, per axis
+	double step[GENERATOR_NUM_ELEMENTS];		// nT, switched on and off by step events
+	double stepInterval;						// Seconds between step events, 0 for none
+} GeneratorModel;
+
+typedef struct
+{
+	double cosTable[GENERATOR_BLOCK + 1];		// cos(i w), i = 0 .. GENERATOR_BLOCK
+	double sinTable[GENERATOR_BLOCK + 1];
+	double cosPhase;							// Phase at the next vector
+	double sinPhase;
+	double amplitude[GENERATOR_NUM_ELEMENTS];
+} Oscillator;
+
+typedef struct
+{
+	GeneratorModel model;
+	double fs;
+	Oscillator oscillators[GENERATOR_MAX_OSCILLATORS];
+	int numOscillators;
+	double phase[GENERATOR_MAX_OSCILLATORS];	// Cycles at the next vector, per tone and then mains harmonic
+	unsigned long long index;					// Vectors generated
+	unsigned long long stepPeriod;				// Vectors between step events, 0 for none
+	int stepOn;									// The step is applied
+	unsigned long long random;					// Noise generator state
+	double pink[GENERATOR_NUM_ELEMENTS][3];		// 1/f filter state, per axis
+	double block[GENERATOR_NUM_ELEMENTS][GENERATOR_BLOCK];
+} FieldGenerator;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+void GeneratorDefaultModel (GeneratorModel *model);
+void GeneratorInit (FieldGenerator *generator, const GeneratorModel *model, double fs);
+void GeneratorSetModel (FieldGenerator *generator, const GeneratorModel *model, double fs);
+void GeneratorFill (FieldGenerator *generator, double *vectors, size_t numVectors);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* FIELD_GENERATOR_H */
@@ -0,0 +1,35 @@
+//==============================================================================
+// Title:		Minimal atomics for the lock-free queues.
+// Description:	Load-acquire, store-release, exchange and compare-exchange
+//				of 32-bit indices, built on the Win32 interlocked functions
+//				under LabWindows/CVI and on the GCC/Clang builtins elsewhere.
+//				AtomicCompareExchange returns the value found, the store
+//				happened when it equals the expected one.
+//==============================================================================
+
+#ifndef MAGNO_ATOMIC_H
+#define MAGNO_ATOMIC_H
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+typedef volatile LONG AtomicIndex;
+
+#define AtomicLoad(p)			((unsigned int)InterlockedCompareExchange((p), 0, 0))
+#define AtomicStore(p, v)		((void)InterlockedExchange((p), (LONG)(v)))
+#define AtomicExchange(p, v)	((unsigned int)InterlockedExchange((p), (LONG)(v)))
+#define AtomicCompareExchange(p, e, v)	((unsigned int)InterlockedCompareExchange((p), (LONG)(v), (LONG)(e)))
+
+#else
+
+typedef volatile unsigned int AtomicIndex;
+
+#define AtomicLoad(p)			__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define AtomicStore(p, v)		__atomic_store_n((p), (unsigned int)(v), __ATOMIC_RELEASE)
+#define AtomicExchange(p, v)	__atomic_exchange_n((p), (unsigned int)(v), __ATOMIC_ACQ_REL)
+#define AtomicCompareExchange(p, e, v)	__sync_val_compare_and_swap((p), (unsigned int)(e), (unsigned int)(v))
+
+#endif
+
+#endif /* MAGNO_ATOMIC_H */
@@ -0,0 +1,215 @@
+//==============================================================================
+// Title:		Portable discrete Fourier transform of real signals.
+// Description:	See MagnoFft.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MagnoFft.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define PI	3.14159265358979323846
+
+void FftPlanInit (FftPlan *plan)
+{
+	memset(plan, 0, sizeof(*plan));
+}
+
+void FftPlanFree (FftPlan *plan)
+{
+	free(plan->twiddle);
+	free(plan->chirp);
+	free(plan->chirpSpectrum);
+	free(plan->work);
+	FftPlanInit (plan);
+}
+
+//-----------------------------------------------------------------------------
+// In-place forward transform of size interleaved complex values, size a
+// power of two. Decimation in time after a bit-reversal permutation.
+//-----------------------------------------------------------------------------
+static void Radix2 (const double *twiddle, double *data, size_t size)
+{
+	size_t i, j, k;
+	size_t half, step;
+	double wr, wi, tr, ti;
+	double *a, *b;
+
+	// Bit-reversal permutation
+	for (i = 1, j = 0; i < size; i++)
+	{
+		for (k = size >> 1; j & k; k >>= 1)
+			j ^= k;
+		j |= k;
+		if (i < j)
+		{
+			tr = data[2 * i];
+			ti = data[2 * i + 1];
+			data[2 * i] = data[2 * j];
+			data[2 * i + 1] = data[2 * j + 1];
+			data[2 * j] = tr;
+			data[2 * j + 1] = ti;
+		}
+	}
+
+	// Butterflies, the twiddle table is strided for the shorter stages
+	for (half = 1, step = size / 2; half < size; half *= 2, step /= 2)
+	{
+		for (i = 0; i < size; i += 2 * half)
+		{
+			for (k = 0; k < half; k++)
+			{
+				wr = twiddle[2 * k * step];
+				wi = twiddle[2 * k * step + 1];
+				a = data + 2 * (i + k);
+				b = a + 2 * half;
+				tr = b[0] * wr - b[1] * wi;
+				ti = b[0] * wi + b[1] * wr;
+				b[0] = a[0] - tr;
+				b[1] = a[1] - ti;
+				a[0] += tr;
+				a[1] += ti;
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Prepare the plan for a transform of length samples, reusing it when the
+// length is unchanged. Returns -1 when out of memory.
+//-----------------------------------------------------------------------------
+int FftPlanPrepare (FftPlan *plan, size_t length)
+{
+	size_t size;
+	size_t i;
+	double angle;
+
+	if (length == plan->length && plan->work)
+		return 0;
+	FftPlanFree (plan);
+	if (length == 0)
+		return 0;
+
+	// Bluestein needs a linear convolution of 2 * length - 1 values
+	for (size = 1; size < length; size *= 2)
+		;
+	if (size != length)
+		for (size = 1; size < 2 * length - 1; size *= 2)
+			;
+
+	plan->twiddle = (double*)malloc(size * sizeof(double));
+	plan->work = (double*)malloc(2 * size * sizeof(double));
+	if (!plan->twiddle || !plan->work)
+	{
+		FftPlanFree (plan);
+		return -1;
+	}
+	plan->length = length;
+	plan->size = size;
+
+	for (i = 0; i < size / 2; i++)
+	{
+		angle = 2.0 * PI * i / size;
+		plan->twiddle[2 * i] = cos(angle);
+		plan->twiddle[2 * i + 1] = -sin(angle);
+	}
+
+	if (size == length)
+		return 0;
+
+	plan->chirp = (double*)malloc(2 * length * sizeof(double));
+	plan->chirpSpectrum = (double*)malloc(2 * size * sizeof(double));
+	if (!plan->chirp || !plan->chirpSpectrum)
+	{
+		FftPlanFree (plan);
+		return -1;
+	}
+
+	// chirp[k] = exp(-i pi k^2 / n), with k^2 reduced mod 2n to keep the angle exact
+	for (i = 0; i < length; i++)
+	{
+		angle = PI * (double)((unsigned long long)i * i % (2 * length)) / length;
+		plan->chirp[2 * i] = cos(angle);
+		plan->chirp[2 * i + 1] = -sin(angle);
+	}
+
+	// The convolution kernel is the conjugate chirp, wrapped around for negative k
+	memset(plan->chirpSpectrum, 0, 2 * size * sizeof(double));
+	for (i = 0; i < length; i++)
+	{
+		plan->chirpSpectrum[2 * i] = plan->chirp[2 * i];
+		plan->chirpSpectrum[2 * i + 1] = -plan->chirp[2 * i + 1];
+		if (i > 0)
+		{
+			plan->chirpSpectrum[2 * (size - i)] = plan->chirp[2 * i];
+			plan->chirpSpectrum[2 * (size - i) + 1] = -plan->chirp[2 * i + 1];
+		}
+	}
+	Radix2 (plan->twiddle, plan->chirpSpectrum, size);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Transform the real signal in real. Like the CVI ReFFT, the real and
+// imaginary parts of all length bins are returned in real and imag.
+//-----------------------------------------------------------------------------
+void FftPlanExecute (FftPlan *plan, double *real, double *imag)
+{
+	double *work = plan->work;
+	const double *chirp = plan->chirp;
+	const double *kernel = plan->chirpSpectrum;
+	size_t length = plan->length;
+	size_t size = plan->size;
+	size_t i;
+	double re, im;
+
+	if (size == length)
+	{
+		for (i = 0; i < length; i++)
+		{
+			work[2 * i] = real[i];
+			work[2 * i + 1] = 0.0;
+		}
+		Radix2 (plan->twiddle, work, size);
+		for (i = 0; i < length; i++)
+		{
+			real[i] = work[2 * i];
+			imag[i] = work[2 * i + 1];
+		}
+		return;
+	}
+
+	// Bluestein: X[k] = chirp[k] * sum(x[j] chirp[j] conj(chirp[k - j]))
+	for (i = 0; i < length; i++)
+	{
+		work[2 * i] = real[i] * chirp[2 * i];
+		work[2 * i + 1] = real[i] * chirp[2 * i + 1];
+	}
+	memset(work + 2 * length, 0, 2 * (size - length) * sizeof(double));
+	Radix2 (plan->twiddle, work, size);
+
+	// Multiply by the kernel spectrum and transform back. The inverse is
+	// the forward transform of the conjugate, conjugated again.
+	for (i = 0; i < size; i++)
+	{
+		re = work[2 * i] * kernel[2 * i] - work[2 * i + 1] * kernel[2 * i + 1];
+		im = work[2 * i] * kernel[2 * i + 1] + work[2 * i + 1] * kernel[2 * i];
+		work[2 * i] = re;
+		work[2 * i + 1] = -im;
+	}
+	Radix2 (plan->twiddle, work, size);
+
+	for (i = 0; i < length; i++)
+	{
+		re = work[2 * i] / size;
+		im = -work[2 * i + 1] / size;
+		real[i] = re * chirp[2 * i] - im * chirp[2 * i + 1];
+		imag[i] = re * chirp[2 * i + 1] + im * chirp[2 * i];
+	}
+}
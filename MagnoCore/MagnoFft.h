@@ -0,0 +1,46 @@
+//==============================================================================
+// Title:		Portable discrete Fourier transform of real signals.
+// Description:	Replaces the LabWindows/CVI ReFFT so the spectrum can be
+//				calculated outside CVI. Power-of-two lengths use an iterative
+//				radix-2 transform; any other length is turned into a
+//				power-of-two convolution with Bluestein's chirp-z algorithm,
+//				so a record of any length is transformed in O(n log n).
+//				A plan holds the twiddle factors, chirps and scratch space for
+//				one length and is reused until the length changes.
+//==============================================================================
+
+#ifndef MAGNO_FFT_H
+#define MAGNO_FFT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	size_t length;				// Transform length
+	size_t size;				// Power-of-two length of the inner transform
+	double *twiddle;			// size / 2 interleaved cos, -sin pairs
+	double *chirp;				// Bluestein chirp, length interleaved pairs
+	double *chirpSpectrum;		// Transform of the zero-padded conjugate chirp
+	double *work;				// size interleaved complex values
+} FftPlan;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+void FftPlanInit (FftPlan *plan);
+int FftPlanPrepare (FftPlan *plan, size_t length);
+void FftPlanExecute (FftPlan *plan, double *real, double *imag);
+void FftPlanFree (FftPlan *plan);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* MAGNO_FFT_H */
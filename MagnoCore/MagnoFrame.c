@@ -0,0 +1,375 @@
+//==============================================================================
+// Title:		Wire frame encoder and streaming decoder.
+// Description:	See MagnoFrame.h for the frame layout.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include "Crc32.h"
+#include "MagnoFrame.h"
+
+//-----------------------------------------------------------------------------
+// Bytes of one vector in an encoding, 0 for an unknown encoding
+//-----------------------------------------------------------------------------
+static int VectorSize (int encoding)
+{
+	switch (encoding)
+	{
+		case FRAME_TYPE_FLOAT64:
+			return FRAME_VECTOR_SIZE;
+		case FRAME_TYPE_FIXED24:
+			return 3 * FRAME_NUM_ELEMENTS;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Size of a frame of the given type, 0 for an unknown type or a block frame
+// with no or too many vectors
+//-----------------------------------------------------------------------------
+int FrameSize (int type, int numVectors)
+{
+	if (type & FRAME_TYPE_BLOCK)
+	{
+		if (numVectors < 1 || numVectors > FRAME_MAX_VECTORS || !VectorSize (type & ~FRAME_TYPE_BLOCK))
+			return 0;
+		return FRAME_HEADER_SIZE + FRAME_BLOCK_HEADER_SIZE
+			   + numVectors * VectorSize (type & ~FRAME_TYPE_BLOCK) + FRAME_CRC_SIZE;
+	}
+
+	switch (type)
+	{
+		case FRAME_TYPE_FLOAT64:
+			return FRAME_HEADER_SIZE + FRAME_FLOAT64_PAYLOAD + 1;
+		case FRAME_TYPE_FIXED24:
+			return FRAME_HEADER_SIZE + FRAME_FIXED24_PAYLOAD + 1;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Size of the frame a header announces, 0 when it isn't a frame start
+//-----------------------------------------------------------------------------
+static int HeaderFrameSize (const unsigned char *frame)
+{
+	int frameSize;
+
+	if (frame[0] != FRAME_SYNC_0 || frame[1] != FRAME_SYNC_1)
+		return 0;
+	if (frame[2] & FRAME_TYPE_BLOCK)
+		return FrameSize (frame[2], frame[3]);
+
+	frameSize = FrameSize (frame[2], 1);
+	if (frame[3] != frameSize - FRAME_HEADER_SIZE - 1)
+		return 0;
+	return frameSize;
+}
+
+//-----------------------------------------------------------------------------
+// XOR of the type byte, the length byte and the payload
+//-----------------------------------------------------------------------------
+static unsigned char FrameCheck (const unsigned char *frame, int payloadSize)
+{
+	unsigned char check = 0;
+	int i;
+
+	for (i = 2; i < FRAME_HEADER_SIZE + payloadSize; i++)
+		check ^= frame[i]; // XOR operation
+	return check;
+}
+
+//-----------------------------------------------------------------------------
+// Little-endian fields, independent of the host byte order
+//-----------------------------------------------------------------------------
+static void PutUnsigned (unsigned char *field, unsigned long long value, int numBytes)
+{
+	int i;
+
+	for (i = 0; i < numBytes; i++, value >>= 8)
+		field[i] = (unsigned char)value;
+}
+
+static unsigned long long GetUnsigned (const unsigned char *field, int numBytes)
+{
+	unsigned long long value = 0;
+	int i;
+
+	for (i = numBytes - 1; i >= 0; i--)
+		value = value << 8 | field[i];
+	return value;
+}
+
+//-----------------------------------------------------------------------------
+// Check a complete frame against its check byte or CRC
+//-----------------------------------------------------------------------------
+static int FrameValid (const unsigned char *frame, int frameSize)
+{
+	if (frame[2] & FRAME_TYPE_BLOCK)
+		return Crc32 (0, frame + 2, frameSize - 2 - FRAME_CRC_SIZE)
+			   == GetUnsigned (frame + frameSize - FRAME_CRC_SIZE, FRAME_CRC_SIZE);
+	return FrameCheck (frame, frameSize - FRAME_HEADER_SIZE - 1) == frame[frameSize - 1];
+}
+
+//-----------------------------------------------------------------------------
+// Fixed-point counts of a vector. Returns 0 when a value is out of range.
+//-----------------------------------------------------------------------------
+static int ToFixed (const double *vector, long *counts)
+{
+	double scaled;
+	int i;
+
+	for (i = 0; i < FRAME_NUM_ELEMENTS; i++)
+	{
+		scaled = floor(vector[i] / FRAME_FIXED_LSB + 0.5);
+		if (!(scaled >= -FRAME_FIXED_MAX && scaled <= FRAME_FIXED_MAX))
+			return 0; // Also rejects NaN
+		counts[i] = (long)scaled;
+	}
+	return 1;
+}
+
+//-----------------------------------------------------------------------------
+// Write one vector in an encoding, the counts for fixed point
+//-----------------------------------------------------------------------------
+static void PutVector (unsigned char *field, int encoding, const double *vector, const long *counts)
+{
+	int i;
+
+	if (encoding == FRAME_TYPE_FIXED24)
+	{
+		for (i = 0; i < FRAME_NUM_ELEMENTS; i++)
+			PutUnsigned (field + 3 * i, (unsigned long)counts[i], 3); // Two's complement
+	}
+	else
+		memcpy(field, vector, FRAME_VECTOR_SIZE);
+}
+
+static void GetVector (const unsigned char *field, int encoding, double *vector)
+{
+	unsigned long count;
+	int i;
+
+	if (encoding == FRAME_TYPE_FIXED24)
+	{
+		for (i = 0; i < FRAME_NUM_ELEMENTS; i++)
+		{
+			count = (unsigned long)GetUnsigned (field + 3 * i, 3);
+			vector[i] = (count & 0x800000 ? (long)count - 0x1000000 : (long)count) * FRAME_FIXED_LSB;
+		}
+	}
+	else
+		memcpy(vector, field, FRAME_VECTOR_SIZE);
+}
+
+//-----------------------------------------------------------------------------
+// Build a frame around one timestamped x, y, z vector in the requested
+// encoding, or in float64 for an anchor frame or a vector that doesn't fit
+// the fixed-point range. Returns the frame size.
+//-----------------------------------------------------------------------------
+int FrameEncode (const FrameSample *sample, int type, unsigned char *frame)
+{
+	unsigned char *payload = frame + FRAME_HEADER_SIZE;
+	long counts[FRAME_NUM_ELEMENTS];
+	int frameSize;
+
+	if (type == FRAME_TYPE_FIXED24
+		&& (sample->sequence % FRAME_ANCHOR_INTERVAL == 0 || !ToFixed (sample->vector, counts)))
+		type = FRAME_TYPE_FLOAT64;
+	frameSize = FrameSize (type, 1);
+
+	frame[0] = FRAME_SYNC_0;
+	frame[1] = FRAME_SYNC_1;
+	frame[2] = (unsigned char)type;
+	frame[3] = (unsigned char)(frameSize - FRAME_HEADER_SIZE - 1);
+
+	if (type == FRAME_TYPE_FIXED24)
+	{
+		PutUnsigned (payload, sample->sequence, 2);
+		PutUnsigned (payload + 2, sample->timestamp, 4);
+		PutVector (payload + 6, type, sample->vector, counts);
+	}
+	else
+	{
+		PutUnsigned (payload, sample->sequence, 4);
+		PutUnsigned (payload + 4, sample->timestamp, 8);
+		PutVector (payload + 12, type, sample->vector, counts);
+	}
+
+	frame[frameSize - 1] = FrameCheck (frame, frameSize - FRAME_HEADER_SIZE - 1);
+	return frameSize;
+}
+
+//-----------------------------------------------------------------------------
+// Build a block frame around 1 to FRAME_MAX_VECTORS samples with consecutive
+// sequence numbers, in float64 when a vector doesn't fit the fixed-point
+// range. Returns the frame size, 0 for a bad number of samples.
+//-----------------------------------------------------------------------------
+int FrameEncodeBlock (const FrameSample *samples, int numSamples, int type, unsigned char *frame)
+{
+	long counts[FRAME_MAX_VECTORS][FRAME_NUM_ELEMENTS];
+	unsigned char *payload = frame + FRAME_HEADER_SIZE;
+	int vectorSize;
+	int frameSize;
+	int i;
+
+	if (numSamples < 1 || numSamples > FRAME_MAX_VECTORS)
+		return 0;
+	for (i = 0; i < numSamples && type == FRAME_TYPE_FIXED24; i++)
+		if (!ToFixed (samples[i].vector, counts[i]))
+			type = FRAME_TYPE_FLOAT64;
+	vectorSize = VectorSize (type);
+	frameSize = FrameSize (FRAME_TYPE_BLOCK | type, numSamples);
+
+	frame[0] = FRAME_SYNC_0;
+	frame[1] = FRAME_SYNC_1;
+	frame[2] = (unsigned char)(FRAME_TYPE_BLOCK | type);
+	frame[3] = (unsigned char)numSamples;
+
+	PutUnsigned (payload, samples[0].sequence, 4);
+	PutUnsigned (payload + 4, samples[0].timestamp, 8);
+	PutUnsigned (payload + 8 + 4, samples[numSamples - 1].timestamp - samples[0].timestamp, 4);
+	payload += FRAME_BLOCK_HEADER_SIZE;
+	for (i = 0; i < numSamples; i++, payload += vectorSize)
+		PutVector (payload, type, samples[i].vector, counts[i]);
+
+	PutUnsigned (payload, Crc32 (0, frame + 2, frameSize - 2 - FRAME_CRC_SIZE), FRAME_CRC_SIZE);
+	return frameSize;
+}
+
+void FrameDecoderInit (FrameDecoder *decoder)
+{
+	memset(decoder, 0, sizeof(*decoder));
+}
+
+//-----------------------------------------------------------------------------
+// Get the free space the caller may receive into, then report it with
+// FrameDecoderCommit. Unparsed bytes are moved to the front first.
+//-----------------------------------------------------------------------------
+unsigned char *FrameDecoderSpace (FrameDecoder *decoder, int *numBytes)
+{
+	if (decoder->head > 0)
+	{
+		memmove(decoder->buffer, decoder->buffer + decoder->head, decoder->tail - decoder->head);
+		decoder->tail -= decoder->head;
+		decoder->head = 0;
+	}
+	*numBytes = FRAME_DECODER_BUFFER_SIZE - decoder->tail;
+	return decoder->buffer + decoder->tail;
+}
+
+void FrameDecoderCommit (FrameDecoder *decoder, int numBytes)
+{
+	decoder->tail += numBytes;
+}
+
+//-----------------------------------------------------------------------------
+// Unpack a checked single-vector frame. Truncated fields continue from the
+// previous frame by the signed difference of their low bits.
+//-----------------------------------------------------------------------------
+static void DecodeFrame (FrameDecoder *decoder, const unsigned char *frame, FrameSample *sample)
+{
+	const unsigned char *payload = frame + FRAME_HEADER_SIZE;
+
+	if (frame[2] == FRAME_TYPE_FIXED24)
+	{
+		sample->sequence = decoder->sequence
+						   + (short)(unsigned short)(GetUnsigned (payload, 2) - decoder->sequence);
+		sample->timestamp = decoder->timestamp
+							+ (int)(unsigned int)(GetUnsigned (payload + 2, 4) - decoder->timestamp);
+		GetVector (payload + 6, FRAME_TYPE_FIXED24, sample->vector);
+	}
+	else
+	{
+		sample->sequence = (unsigned int)GetUnsigned (payload, 4);
+		sample->timestamp = GetUnsigned (payload + 4, 8);
+		GetVector (payload + 12, FRAME_TYPE_FLOAT64, sample->vector);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Unpack one vector of a checked block frame
+//-----------------------------------------------------------------------------
+static void DecodeBlockVector (const unsigned char *frame, int index, FrameSample *sample)
+{
+	const unsigned char *payload = frame + FRAME_HEADER_SIZE;
+	int encoding = frame[2] & ~FRAME_TYPE_BLOCK;
+	int numVectors = frame[3];
+
+	sample->sequence = (unsigned int)GetUnsigned (payload, 4) + index;
+	sample->timestamp = GetUnsigned (payload + 4, 8);
+	if (numVectors > 1)
+		sample->timestamp += GetUnsigned (payload + 8 + 4, 4) * index / (numVectors - 1);
+	GetVector (payload + FRAME_BLOCK_HEADER_SIZE + index * VectorSize (encoding), encoding, sample->vector);
+}
+
+//-----------------------------------------------------------------------------
+// Extract the next valid vector. Returns 0 when more bytes are needed.
+//-----------------------------------------------------------------------------
+int FrameDecoderNext (FrameDecoder *decoder, FrameSample *sample)
+{
+	unsigned char *frame;
+	int frameSize;
+
+	while (decoder->tail - decoder->head >= FRAME_HEADER_SIZE)
+	{
+		frame = decoder->buffer + decoder->head;
+		frameSize = HeaderFrameSize (frame);
+
+		if (decoder->blockIndex == 0)
+		{
+			if (!frameSize)
+			{
+				// Not a frame start, hunt for the sync word one byte further
+				decoder->head++;
+				decoder->bytesSkipped++;
+				continue;
+			}
+
+			if (decoder->tail - decoder->head < frameSize)
+				break; // Wait for the rest of the frame
+
+			if (!FrameValid (frame, frameSize))
+			{
+				// Corrupted frame, resynchronize on the byte after its sync word
+				decoder->head++;
+				decoder->framesDropped++;
+				continue;
+			}
+
+			if (frame[2] == FRAME_TYPE_FIXED24 && !decoder->anchored)
+			{
+				// Nothing to extend the truncated fields from yet
+				decoder->head += frameSize;
+				decoder->framesUnanchored++;
+				continue;
+			}
+			decoder->framesDecoded++;
+
+			if (!(frame[2] & FRAME_TYPE_BLOCK))
+			{
+				DecodeFrame (decoder, frame, sample);
+				decoder->head += frameSize;
+				decoder->sequence = sample->sequence;
+				decoder->timestamp = sample->timestamp;
+				decoder->anchored = 1;
+				return 1;
+			}
+		}
+
+		// Hand out the vectors of a checked block frame one by one
+		DecodeBlockVector (frame, decoder->blockIndex++, sample);
+		if (decoder->blockIndex == frame[3])
+		{
+			decoder->head += frameSize;
+			decoder->blockIndex = 0;
+		}
+		decoder->sequence = sample->sequence;
+		decoder->timestamp = sample->timestamp;
+		decoder->anchored = 1;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,126 @@
+//==============================================================================
+// Title:		Wire frame format shared by the transmitter and the monitor.
+// Description:	Vectors travel one per frame, or up to FRAME_MAX_VECTORS per
+//				block frame:
+//
+//					| SYNC_0 | SYNC_1 | TYPE | LEN | payload (LEN bytes) | CHECK |
+//					| SYNC_0 | SYNC_1 | TYPE | COUNT | payload | CRC-32 (4) |
+//
+//				The sync word lets the receiver find frame boundaries in the
+//				byte stream, and the type and length or count bytes reject
+//				false sync matches early. CHECK is the XOR of TYPE, LEN and
+//				the payload; the CRC-32 (IEEE 802.3) of a block frame covers
+//				TYPE, COUNT and the payload and also catches swapped bytes
+//				and burst errors. The streaming decoder scans forward byte by
+//				byte after a corrupted frame, so a dropped or extra byte costs
+//				at most one frame.
+//				The payload starts with a sequence number and the sender's
+//				monotonic clock in microseconds, followed by the vector, so
+//				the receiver can detect lost frames and measure the real
+//				sampling rate. TYPE says how the payload is encoded, so the
+//				sender can pick an encoding per frame without negotiation:
+//
+//				FRAME_TYPE_FLOAT64 (41-byte frame)
+//					| SEQUENCE (4) | TIMESTAMP (8) | x, y, z float64 (24) |
+//
+//				FRAME_TYPE_FIXED24 (20-byte frame)
+//					| SEQUENCE (2) | TIMESTAMP (4) | x, y, z int24 (9) |
+//
+//				FRAME_TYPE_BLOCK | FRAME_TYPE_FLOAT64 or FRAME_TYPE_FIXED24
+//					| SEQUENCE (4) | TIMESTAMP (8) | SPAN (4) | COUNT vectors |
+//
+//				Fixed-point values are signed multiples of FRAME_FIXED_LSB,
+//				which holds the sensor's two decimals exactly and covers
+//				+-83886 nT. The decoder extends the truncated sequence number
+//				and timestamp from the previous frame, and drops FIXED24
+//				frames until a frame with the full fields has anchored it.
+//				FrameEncode falls back to FRAME_TYPE_FLOAT64 for a vector out
+//				of the fixed range, and every FRAME_ANCHOR_INTERVAL vectors so
+//				the receiver recovers the full fields after a long outage. A
+//				sender starts its sequence numbers at a multiple of
+//				FRAME_ANCHOR_INTERVAL, so its first frame is an anchor.
+//				A block frame holds consecutive sequence numbers. SPAN is the
+//				time from its first to its last vector, the vectors between
+//				are timestamped evenly.
+//				All fields are little-endian.
+//==============================================================================
+
+#ifndef MAGNO_FRAME_H
+#define MAGNO_FRAME_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define FRAME_SYNC_0			0xA5
+#define FRAME_SYNC_1			0x5A
+#define FRAME_NUM_ELEMENTS		3 									// x, y, z vector
+#define FRAME_VECTOR_SIZE		(sizeof(double) * FRAME_NUM_ELEMENTS)
+#define FRAME_HEADER_SIZE		4 									// Sync word, type and length byte
+
+#define FRAME_TYPE_FLOAT64		0x01
+#define FRAME_TYPE_FIXED24		0x02
+#define FRAME_TYPE_BLOCK		0x10 								// Flag, several vectors under one CRC
+
+#define FRAME_FLOAT64_PAYLOAD	(4 + 8 + FRAME_VECTOR_SIZE) 		// Sequence, timestamp, vector
+#define FRAME_FIXED24_PAYLOAD	(2 + 4 + 3 * FRAME_NUM_ELEMENTS)
+#define FRAME_FIXED_LSB			0.01 								// nT per fixed-point count
+#define FRAME_FIXED_MAX			0x7FFFFF 							// Largest int24 count
+#define FRAME_ANCHOR_INTERVAL	1024 								// Sequence numbers between full frames
+
+#define FRAME_BLOCK_HEADER_SIZE	(4 + 8 + 4) 						// Sequence, timestamp, span
+#define FRAME_CRC_SIZE			4
+#define FRAME_MAX_VECTORS		64 									// Vectors in the largest block frame
+
+#define FRAME_MIN_SIZE			(FRAME_HEADER_SIZE + FRAME_FIXED24_PAYLOAD + 1) // Include the check byte
+#define FRAME_MAX_SIZE			(FRAME_HEADER_SIZE + FRAME_BLOCK_HEADER_SIZE + FRAME_MAX_VECTORS * FRAME_VECTOR_SIZE + FRAME_CRC_SIZE)
+#define FRAME_MAX_VECTOR_COST	(FRAME_HEADER_SIZE + FRAME_BLOCK_HEADER_SIZE + FRAME_VECTOR_SIZE + FRAME_CRC_SIZE) // Most bytes a frame spends on one vector
+
+#define FRAME_DECODER_BUFFER_SIZE	8192
+#define FRAME_TIMESTAMP_UNIT		1e-6 	// Seconds per timestamp tick
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	unsigned int sequence;			// Increments by one per vector, wraps around
+	unsigned long long timestamp;	// Sender clock in FRAME_TIMESTAMP_UNIT
+	double vector[FRAME_NUM_ELEMENTS];
+} FrameSample;
+
+typedef struct
+{
+	unsigned char buffer[FRAME_DECODER_BUFFER_SIZE];
+	int head;						// Next byte to examine
+	int tail;						// End of the received bytes
+	int blockIndex;					// Next vector of the checked block frame at head, 0 for none
+	int anchored;					// A frame with the full fields has been decoded
+	unsigned int sequence;			// Last sequence number, extends truncated ones
+	unsigned long long timestamp;	// Last timestamp, extends truncated ones
+	unsigned int framesDecoded;		// Frames that passed the check
+	unsigned int framesDropped;		// Frames discarded on a failed check
+	unsigned int framesUnanchored;	// Truncated frames discarded before an anchor
+	unsigned int bytesSkipped;		// Bytes discarded while searching for sync
+} FrameDecoder;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int FrameEncode (const FrameSample *sample, int type, unsigned char *frame);
+int FrameEncodeBlock (const FrameSample *samples, int numSamples, int type, unsigned char *frame);
+int FrameSize (int type, int numVectors);
+
+void FrameDecoderInit (FrameDecoder *decoder);
+unsigned char *FrameDecoderSpace (FrameDecoder *decoder, int *numBytes);
+void FrameDecoderCommit (FrameDecoder *decoder, int numBytes);
+int FrameDecoderNext (FrameDecoder *decoder, FrameSample *sample);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* MAGNO_FRAME_H */
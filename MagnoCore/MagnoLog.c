@@ -0,0 +1,187 @@
+//==============================================================================
+// Title:		Binary log format for recorded x, y, z vectors.
+// Description:	See MagnoLog.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "MagnoLog.h"
+#include "TextParse.h"
+
+//-----------------------------------------------------------------------------
+// Write the header of a new log. Returns -1 on a write error.
+//-----------------------------------------------------------------------------
+int MagnoLogWriteHeader (FILE *file, double fs, double startTime)
+{
+	MagnoLogHeader header;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGNO_LOG_MAGIC, sizeof(header.magic));
+	header.version = MAGNO_LOG_VERSION;
+	header.headerSize = MAGNO_LOG_HEADER_SIZE;
+	header.fs = fs;
+	header.startTime = startTime;
+	header.numElements = MAGNO_LOG_NUM_ELEMENTS;
+
+	return fwrite(&header, sizeof(header), 1, file) == 1 ? 0 : -1;
+}
+
+//-----------------------------------------------------------------------------
+// Map a binary log for reading. A trailing partial record, left by a capture
+// that was cut short, is ignored.
+//-----------------------------------------------------------------------------
+int MagnoLogOpen (MagnoLogReader *reader, const char *pathname)
+{
+	memset(reader, 0, sizeof(*reader));
+
+	if (MappedFileOpen (&reader->file, pathname) < 0)
+		return MAGNO_LOG_ERROR_FILE;
+
+	if (reader->file.size < sizeof(MagnoLogHeader))
+	{
+		MagnoLogClose (reader);
+		return MAGNO_LOG_ERROR_FORMAT;
+	}
+	memcpy(&reader->header, reader->file.data, sizeof(MagnoLogHeader));
+
+	if (memcmp(reader->header.magic, MAGNO_LOG_MAGIC, sizeof(reader->header.magic)) != 0
+		|| reader->header.version != MAGNO_LOG_VERSION
+		|| reader->header.numElements != MAGNO_LOG_NUM_ELEMENTS
+		|| reader->header.headerSize < sizeof(MagnoLogHeader)
+		|| reader->header.headerSize % sizeof(double) != 0
+		|| reader->header.headerSize > reader->file.size
+		|| !(reader->header.fs > 0))
+	{
+		MagnoLogClose (reader);
+		return MAGNO_LOG_ERROR_FORMAT;
+	}
+
+	reader->vectors = (const double*)(reader->file.data + reader->header.headerSize);
+	reader->numVectors = (reader->file.size - reader->header.headerSize) / MAGNO_LOG_RECORD_SIZE;
+	return 0;
+}
+
+void MagnoLogClose (MagnoLogReader *reader)
+{
+	MappedFileClose (&reader->file);
+	memset(reader, 0, sizeof(*reader));
+}
+
+//-----------------------------------------------------------------------------
+// Parse one "HH:MM:SS <tab> x <tab> y <tab> z" row of a text log. Returns
+// the seconds of the day, or -1 when the line isn't a data row.
+//-----------------------------------------------------------------------------
+static int ParseTextRow (const char *cursor, const char *end, double *vector)
+{
+	unsigned int hours, minutes, seconds;
+	int i;
+
+	cursor = SkipBlanks (cursor, end);
+	if (!(cursor = ParseUnsigned (cursor, end, &hours)) || cursor >= end || *cursor++ != ':'
+		|| !(cursor = ParseUnsigned (cursor, end, &minutes)) || cursor >= end || *cursor++ != ':'
+		|| !(cursor = ParseUnsigned (cursor, end, &seconds)))
+		return -1;
+
+	for (i = 0; i < MAGNO_LOG_NUM_ELEMENTS; i++)
+	{
+		cursor = SkipBlanks (cursor, end);
+		if (!(cursor = ParseDouble (cursor, end, &vector[i])))
+			return -1;
+	}
+	return (int)((hours * 60 + minutes) * 60 + seconds);
+}
+
+//-----------------------------------------------------------------------------
+// Convert a text log of the old "HH:MM:SS x y z" format into a binary log.
+// The rows only carry whole seconds, so the sampling rate is estimated from
+// the rows between the first and the last change of the second; defaultFs is
+// used when the log spans less than that. The rows carry no date: lastDay is
+// the date/time of midnight on the day of the last row, e.g. of the text
+// file's modification date, and the start time is counted back from it over
+// the midnights the rows pass.
+//-----------------------------------------------------------------------------
+int MagnoLogConvertText (const char *textPathname, const char *logPathname, double defaultFs, double lastDay)
+{
+	MappedFile text;
+	FILE *file;
+	const char *cursor;
+	const char *end;
+	double vector[MAGNO_LOG_NUM_ELEMENTS];
+	double fs = defaultFs;
+	double elapsed;
+	double startTime;
+	size_t numVectors = 0;
+	size_t firstTick = 0;		// Row where the second first changed
+	size_t lastTick = 0;		// Row where the second last changed
+	int firstSecond = -1;
+	int lastSecond = -1;
+	int tickSecond = -1;
+	int second;
+	int days = 0;				// Midnight rollovers
+	int error = 0;
+
+	if (MappedFileOpen (&text, textPathname) < 0)
+		return MAGNO_LOG_ERROR_FILE;
+
+	file = fopen (logPathname, "wb");
+	if (!file)
+	{
+		MappedFileClose (&text);
+		return MAGNO_LOG_ERROR_FILE;
+	}
+	setvbuf (file, NULL, _IOFBF, 1 << 20);
+
+	// Placeholder header, rewritten once the sampling rate is known
+	error = MagnoLogWriteHeader (file, fs, 0) < 0;
+
+	cursor = text.data;
+	end = text.data + text.size;
+	while (!error && cursor < end)
+	{
+		second = ParseTextRow (cursor, end, vector);
+		cursor = SkipLine (cursor, end);
+		if (second < 0)
+			continue;
+
+		if (firstSecond < 0)
+			firstSecond = lastSecond = second;
+		if (second < lastSecond)
+			days++;
+		if (second != lastSecond)
+		{
+			if (tickSecond < 0)
+			{
+				firstTick = numVectors;
+				tickSecond = second + 86400 * days;
+			}
+			lastTick = numVectors;
+			lastSecond = second;
+		}
+
+		error = fwrite(vector, sizeof(vector), 1, file) != 1;
+		numVectors++;
+	}
+
+	if (tickSecond >= 0)
+	{
+		elapsed = lastSecond + 86400.0 * days - tickSecond;
+		if (elapsed >= 1 && lastTick > firstTick)
+			fs = (lastTick - firstTick) / elapsed;
+	}
+
+	startTime = lastDay - 86400.0 * days + firstSecond;
+	if (!error && numVectors > 0)
+		error = fseek (file, 0, SEEK_SET) != 0 || MagnoLogWriteHeader (file, fs, startTime) < 0;
+	if (fclose (file) != 0)
+		error = 1;
+	MappedFileClose (&text);
+
+	if (error || numVectors == 0)
+	{
+		remove (logPathname);
+		return error ? MAGNO_LOG_ERROR_FILE : MAGNO_LOG_ERROR_FORMAT;
+	}
+	return 0;
+}
@@ -0,0 +1,69 @@
+//==============================================================================
+// Title:		Binary log format for recorded x, y, z vectors.
+// Description:	A log is a 64-byte header followed by packed native float64
+//				x, y, z triplets. The time of vector n is startTime + n / fs.
+//				Records start on an 8-byte boundary so a mapped log can be
+//				used as an array of doubles in place.
+//				Text logs written by older versions are converted once into
+//				a binary log next to them, which is then mapped like any other.
+//==============================================================================
+
+#ifndef MAGNO_LOG_H
+#define MAGNO_LOG_H
+
+#include <stdio.h>
+#include "MappedFile.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define MAGNO_LOG_MAGIC			"MAGNOLOG"
+#define MAGNO_LOG_VERSION		1
+#define MAGNO_LOG_HEADER_SIZE	64
+#define MAGNO_LOG_NUM_ELEMENTS	3 									// x, y, z vector
+#define MAGNO_LOG_RECORD_SIZE	(sizeof(double) * MAGNO_LOG_NUM_ELEMENTS)
+#define MAGNO_LOG_EXTENSION		".mlog"
+
+// Return values of MagnoLogOpen and MagnoLogConvertText
+#define MAGNO_LOG_ERROR_FILE	-1 		// Can't open, map or write a file
+#define MAGNO_LOG_ERROR_FORMAT	-2 		// Not a log in the expected format
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	char magic[8];					// MAGNO_LOG_MAGIC, not terminated
+	unsigned int version;
+	unsigned int headerSize;		// Offset of the first record
+	double fs;						// Sampling rate
+	double startTime;				// CVI date/time of the first vector
+	unsigned int numElements;
+	char reserved[28];				// Zero, pads the header to 64 bytes
+} MagnoLogHeader;
+
+typedef struct
+{
+	MappedFile file;
+	MagnoLogHeader header;
+	const double *vectors;			// Interleaved x, y, z, inside the mapping
+	size_t numVectors;
+} MagnoLogReader;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int MagnoLogWriteHeader (FILE *file, double fs, double startTime);
+int MagnoLogOpen (MagnoLogReader *reader, const char *pathname);
+void MagnoLogClose (MagnoLogReader *reader);
+int MagnoLogConvertText (const char *textPathname, const char *logPathname, double defaultFs, double lastDay);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* MAGNO_LOG_H */
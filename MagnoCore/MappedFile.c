@@ -0,0 +1,117 @@
+//==============================================================================
+// Title:		Read-only memory-mapped files.
+// Description:	See MappedFile.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+//-----------------------------------------------------------------------------
+// Map a whole file for reading. Returns -1 when it can't be opened or mapped.
+//-----------------------------------------------------------------------------
+int MappedFileOpen (MappedFile *mappedFile, const char *pathname)
+{
+	LARGE_INTEGER size;
+	HANDLE file;
+	HANDLE mapping;
+
+	memset(mappedFile, 0, sizeof(*mappedFile));
+
+	file = CreateFileA (pathname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return -1;
+	if (!GetFileSizeEx (file, &size) || (ULONGLONG)size.QuadPart > (size_t)-1)
+	{
+		CloseHandle (file);
+		return -1;
+	}
+	mappedFile->file = file;
+	mappedFile->size = (size_t)size.QuadPart;
+	if (mappedFile->size == 0)
+		return 0; // Empty files can't be mapped, there's nothing to read anyway
+
+	mapping = CreateFileMappingA (file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping)
+	{
+		MappedFileClose (mappedFile);
+		return -1;
+	}
+	mappedFile->mapping = mapping;
+
+	mappedFile->data = (const char*)MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!mappedFile->data)
+	{
+		MappedFileClose (mappedFile);
+		return -1;
+	}
+	return 0;
+}
+
+void MappedFileClose (MappedFile *mappedFile)
+{
+	if (mappedFile->data)
+		UnmapViewOfFile (mappedFile->data);
+	if (mappedFile->mapping)
+		CloseHandle (mappedFile->mapping);
+	if (mappedFile->file)
+		CloseHandle (mappedFile->file);
+	memset(mappedFile, 0, sizeof(*mappedFile));
+}
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int MappedFileOpen (MappedFile *mappedFile, const char *pathname)
+{
+	struct stat info;
+	void *data;
+	int fd;
+
+	memset(mappedFile, 0, sizeof(*mappedFile));
+
+	fd = open (pathname, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat (fd, &info) < 0)
+	{
+		close (fd);
+		return -1;
+	}
+	mappedFile->size = (size_t)info.st_size;
+
+	if (mappedFile->size > 0)
+	{
+		data = mmap (NULL, mappedFile->size, PROT_READ, MAP_SHARED, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			close (fd);
+			memset(mappedFile, 0, sizeof(*mappedFile));
+			return -1;
+		}
+		mappedFile->data = (const char*)data;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	close (fd);
+	return 0;
+}
+
+void MappedFileClose (MappedFile *mappedFile)
+{
+	if (mappedFile->data)
+		munmap ((void*)mappedFile->data, mappedFile->size);
+	memset(mappedFile, 0, sizeof(*mappedFile));
+}
+
+#endif
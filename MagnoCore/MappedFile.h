@@ -0,0 +1,40 @@
+//==============================================================================
+// Title:		Read-only memory-mapped files.
+// Description:	Maps a whole file into the address space, using Win32 file
+//				mappings under LabWindows/CVI and mmap elsewhere. The pages
+//				are loaded on demand by the OS, so opening a large file is
+//				cheap. 32-bit builds are limited by their address space; use
+//				a 64-bit configuration for logs over about 1 GB.
+//==============================================================================
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	const char *data;			// First byte of the file, NULL for an empty file
+	size_t size;				// Bytes mapped
+	void *file;					// OS handles
+	void *mapping;
+} MappedFile;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int MappedFileOpen (MappedFile *mappedFile, const char *pathname);
+void MappedFileClose (MappedFile *mappedFile);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* MAPPED_FILE_H */
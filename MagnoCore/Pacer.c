@@ -0,0 +1,100 @@
+//==============================================================================
+// Title:		Deadline-based pacing of transmitted vectors.
+// Description:	See Pacer.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include "Pacer.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define PAUSED_WAIT		0.05 	// Seconds between checks while paused
+
+void PacerInit (Pacer *pacer, double rate, unsigned int burst, double now)
+{
+	pacer->maxLag = PACER_MAX_LAG;
+	pacer->slips = 0;
+	PacerSetRate (pacer, rate, burst, now);
+}
+
+//-----------------------------------------------------------------------------
+// Change the rate or burst size, the new schedule starts now
+//-----------------------------------------------------------------------------
+void PacerSetRate (Pacer *pacer, double rate, unsigned int burst, double now)
+{
+	pacer->rate = rate > 0 ? rate : 0.0;
+	pacer->burst = burst > 0 ? burst : 1;
+	pacer->origin = now;
+	pacer->released = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Number of vectors to send now, at most maxVectors. Vectors held back by
+// maxVectors stay due for the next call.
+//-----------------------------------------------------------------------------
+unsigned int PacerDue (Pacer *pacer, double now, unsigned int maxVectors)
+{
+	unsigned long long bursts;
+	unsigned long long due;
+
+	if (pacer->rate <= 0 || now < pacer->origin)
+		return 0;
+
+	// Burst k is due at origin + k * burst / rate, burst 0 at origin
+	bursts = (unsigned long long)((now - pacer->origin) * pacer->rate / pacer->burst) + 1;
+	if (bursts * pacer->burst <= pacer->released)
+		return 0;
+	due = bursts * pacer->burst - pacer->released;
+
+	if (due > pacer->burst && (double)(due - pacer->burst) / pacer->rate > pacer->maxLag)
+	{
+		// Too far behind, start a new schedule rather than flood the link
+		pacer->slips++;
+		pacer->origin = now;
+		pacer->released = 0;
+		due = pacer->burst;
+	}
+
+	if (due > maxVectors)
+		due = maxVectors;
+	pacer->released += due;
+	return (unsigned int)due;
+}
+
+//-----------------------------------------------------------------------------
+// Time the next vectors are due, now or earlier when some are already due
+//-----------------------------------------------------------------------------
+double PacerNextDeadline (const Pacer *pacer, double now)
+{
+	unsigned long long bursts;
+
+	if (pacer->rate <= 0)
+		return now + PAUSED_WAIT;
+
+	// A partly released burst is still due
+	bursts = pacer->released / pacer->burst;
+	return pacer->origin + bursts * pacer->burst / pacer->rate;
+}
+
+//-----------------------------------------------------------------------------
+// The instant vector index of the current schedule stands for. Bursts only
+// decide when vectors are sent, every vector keeps its own time.
+//-----------------------------------------------------------------------------
+double PacerTime (const Pacer *pacer, unsigned long long index)
+{
+	if (pacer->rate <= 0)
+		return pacer->origin;
+	return pacer->origin + index / pacer->rate;
+}
+
+//-----------------------------------------------------------------------------
+// Highest vector rate a serial link carries with one frame per vector.
+// bitsPerByte counts the start, data, parity and stop bits.
+//-----------------------------------------------------------------------------
+double PacerMaxRate (double baudrate, int bitsPerByte, unsigned int frameSize)
+{
+	return baudrate / ((double)bitsPerByte * frameSize);
+}
@@ -0,0 +1,55 @@
+//==============================================================================
+// Title:		Deadline-based pacing of transmitted vectors.
+// Description:	Vector n is due at origin + n / rate on an absolute schedule,
+//				so sleep granularity and jitter delay single vectors but never
+//				accumulate into a rate error. Whatever is due when the sender
+//				wakes up is released at once, which keeps rates of several kHz
+//				exact with millisecond timers. In burst mode vectors are
+//				released in groups of burst at burst / rate intervals, and
+//				each vector still stands for its own time origin + n / rate.
+//				If the sender falls more than maxLag behind, e.g. while the
+//				link is blocked, the schedule is restarted from the current
+//				time instead of catching up in one long burst; these slips
+//				are counted. Times are seconds on any monotonic clock.
+//==============================================================================
+
+#ifndef PACER_H
+#define PACER_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define PACER_MAX_LAG	0.25 	// Seconds behind schedule before the schedule restarts
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	double rate;					// Vectors per second, 0 pauses
+	unsigned int burst;				// Vectors released together
+	double origin;					// Time of the first vector of the schedule
+	unsigned long long released;	// Vectors released since origin
+	double maxLag;
+	unsigned int slips;				// Schedule restarts after falling behind
+} Pacer;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+void PacerInit (Pacer *pacer, double rate, unsigned int burst, double now);
+void PacerSetRate (Pacer *pacer, double rate, unsigned int burst, double now);
+unsigned int PacerDue (Pacer *pacer, double now, unsigned int maxVectors);
+double PacerNextDeadline (const Pacer *pacer, double now);
+double PacerTime (const Pacer *pacer, unsigned long long index);
+double PacerMaxRate (double baudrate, int bitsPerByte, unsigned int frameSize);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* PACER_H */
@@ -0,0 +1,143 @@
+//==============================================================================
+// Title:		Bounded playback of recorded x, y, z vectors.
+// Description:	See Playback.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "Playback.h"
+
+//-----------------------------------------------------------------------------
+// Play all vectors in a loop at normal speed
+//-----------------------------------------------------------------------------
+void PlaybackInit (Playback *playback, const double *vectors, size_t numVectors)
+{
+	memset(playback, 0, sizeof(*playback));
+	playback->vectors = vectors;
+	playback->numVectors = numVectors;
+	playback->end = numVectors;
+	playback->direction = 1;
+	playback->mode = PLAYBACK_LOOP;
+	playback->speed = 1.0;
+}
+
+//-----------------------------------------------------------------------------
+// Play vectors start to end - 1, end 0 meaning the last vector. The range is
+// clamped to the vectors and holds at least one. Playback outside the new
+// range restarts at its start.
+//-----------------------------------------------------------------------------
+void PlaybackSetRange (Playback *playback, size_t start, size_t end)
+{
+	if (end == 0 || end > playback->numVectors)
+		end = playback->numVectors;
+	if (start >= end)
+		start = end ? end - 1 : 0;
+
+	playback->start = start;
+	playback->end = end;
+	if (playback->position < start || playback->position >= end)
+		PlaybackSeek (playback, start);
+}
+
+void PlaybackSetMode (Playback *playback, PlaybackMode mode)
+{
+	if (mode != PLAYBACK_PING_PONG)
+		playback->direction = 1;
+	playback->mode = mode;
+}
+
+void PlaybackSetSpeed (Playback *playback, double speed)
+{
+	if (speed < PLAYBACK_MIN_SPEED)
+		speed = PLAYBACK_MIN_SPEED;
+	if (speed > PLAYBACK_MAX_SPEED)
+		speed = PLAYBACK_MAX_SPEED;
+	playback->speed = speed;
+}
+
+//-----------------------------------------------------------------------------
+// Continue forwards from a vector inside the range, also after a stop
+//-----------------------------------------------------------------------------
+void PlaybackSeek (Playback *playback, size_t position)
+{
+	if (position < playback->start)
+		position = playback->start;
+	if (position >= playback->end)
+		position = playback->end ? playback->end - 1 : 0;
+
+	playback->position = position;
+	playback->direction = 1;
+	playback->phase = 0.0;
+	playback->finished = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Move numSteps vectors on within the range, as the mode has it
+//-----------------------------------------------------------------------------
+static void Advance (Playback *playback, size_t numSteps)
+{
+	size_t length = playback->end - playback->start;
+	size_t offset = playback->position - playback->start;
+	size_t period;
+
+	switch (playback->mode)
+	{
+		case PLAYBACK_LOOP:
+			playback->position = playback->start + (offset + numSteps % length) % length;
+			break;
+
+		case PLAYBACK_PING_PONG:
+			if (length < 2)
+				break;
+
+			// Unfold the way there and back into one period and move along it
+			period = 2 * (length - 1);
+			if (playback->direction < 0)
+				offset = period - offset;
+			offset = (offset + numSteps % period) % period;
+			if (offset < length)
+			{
+				playback->position = playback->start + offset;
+				playback->direction = 1;
+			}
+			else
+			{
+				playback->position = playback->start + period - offset;
+				playback->direction = -1;
+			}
+			break;
+
+		case PLAYBACK_STOP:
+			if (numSteps >= length - offset)
+			{
+				playback->position = playback->end - 1;
+				playback->finished = 1;
+			}
+			else
+				playback->position += numSteps;
+			break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// The vector to play now, NULL once stopped or when there are no vectors.
+// The pointer stays valid as long as the vectors do.
+//-----------------------------------------------------------------------------
+const double *PlaybackNext (Playback *playback)
+{
+	const double *vector;
+	size_t numSteps;
+
+	if (playback->finished || playback->end == 0)
+		return NULL;
+	vector = playback->vectors + playback->position * PLAYBACK_NUM_ELEMENTS;
+
+	playback->phase += playback->speed;
+	numSteps = (size_t)playback->phase;
+	playback->phase -= numSteps;
+	if (numSteps)
+		Advance (playback, numSteps);
+	return vector;
+}
@@ -0,0 +1,67 @@
+//==============================================================================
+// Title:		Bounded playback of recorded x, y, z vectors.
+// Description:	Plays a range of an array of vectors, such as a mapped log,
+//				one vector at a time. At the end of the range playback loops
+//				back to the start, turns around (ping-pong) or stops, so it
+//				never reads outside the range however long it runs. The speed
+//				is the number of recorded vectors advanced per vector played:
+//				below 1 vectors repeat, above 1 they are skipped, while the
+//				rate vectors are played at stays the caller's. Position,
+//				range, mode and speed can all change during playback.
+//==============================================================================
+
+#ifndef PLAYBACK_H
+#define PLAYBACK_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define PLAYBACK_NUM_ELEMENTS	3 		// x, y, z vector
+#define PLAYBACK_MIN_SPEED		0.1
+#define PLAYBACK_MAX_SPEED		100.0
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef enum
+{
+	PLAYBACK_LOOP,					// Start over at the start of the range
+	PLAYBACK_PING_PONG,				// Play the range forwards and backwards in turn
+	PLAYBACK_STOP					// Stop after the last vector of the range
+} PlaybackMode;
+
+typedef struct
+{
+	const double *vectors;			// Interleaved x, y, z
+	size_t numVectors;
+	size_t start;					// First vector of the range
+	size_t end;						// One past the last vector of the range
+	size_t position;				// Vector played next
+	int direction;					// 1 forwards, -1 backwards
+	PlaybackMode mode;
+	double speed;					// Recorded vectors advanced per vector played
+	double phase;					// Fraction of a vector advanced but not yet moved
+	int finished;					// Stopped at the end of the range
+} Playback;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+void PlaybackInit (Playback *playback, const double *vectors, size_t numVectors);
+void PlaybackSetRange (Playback *playback, size_t start, size_t end);
+void PlaybackSetMode (Playback *playback, PlaybackMode mode);
+void PlaybackSetSpeed (Playback *playback, double speed);
+void PlaybackSeek (Playback *playback, size_t position);
+const double *PlaybackNext (Playback *playback);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* PLAYBACK_H */
@@ -0,0 +1,156 @@
+//==============================================================================
+// Title:		Append-only store of received x, y, z vectors.
+// Description:	See SampleStore.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include "SampleStore.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define BLOCK_SIZE		(SAMPLE_STORE_BLOCK_VECTORS * SAMPLE_STORE_NUM_ELEMENTS)
+#define MIN_INDEX_SIZE	16
+
+void SampleStoreInit (SampleStore *store)
+{
+	memset(store, 0, sizeof(*store));
+}
+
+void SampleStoreFree (SampleStore *store)
+{
+	size_t i;
+
+	if (!store->external)
+		for (i = 0; i < store->numBlocks; i++)
+			free(store->blocks[i]);
+	free(store->blocks);
+	SampleStoreInit (store);
+}
+
+//-----------------------------------------------------------------------------
+// Allocate one more block, doubling the index when it is full
+//-----------------------------------------------------------------------------
+static int AddBlock (SampleStore *store)
+{
+	double **blocks;
+	double *block;
+	size_t indexSize;
+
+	if (store->numBlocks == store->indexSize)
+	{
+		indexSize = store->indexSize ? 2 * store->indexSize : MIN_INDEX_SIZE;
+		blocks = (double**)realloc(store->blocks, indexSize * sizeof(double*));
+		if (!blocks)
+			return -1;
+		store->blocks = blocks;
+		store->indexSize = indexSize;
+	}
+
+	block = (double*)malloc(BLOCK_SIZE * sizeof(double));
+	if (!block)
+		return -1;
+	store->blocks[store->numBlocks++] = block;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Append interleaved x, y, z vectors. Returns -1 when out of memory or when
+// the store is attached to external vectors.
+//-----------------------------------------------------------------------------
+int SampleStoreAppend (SampleStore *store, const double *vectors, size_t numVectors)
+{
+	size_t offset;
+	size_t numCopy;
+
+	if (store->external)
+		return -1;
+
+	while (numVectors > 0)
+	{
+		offset = store->count % SAMPLE_STORE_BLOCK_VECTORS;
+		if (offset == 0 && store->count / SAMPLE_STORE_BLOCK_VECTORS == store->numBlocks)
+			if (AddBlock (store) < 0)
+				return -1;
+
+		// Copy as much as fits in the current block
+		numCopy = SAMPLE_STORE_BLOCK_VECTORS - offset;
+		if (numCopy > numVectors)
+			numCopy = numVectors;
+		memcpy(store->blocks[store->count / SAMPLE_STORE_BLOCK_VECTORS] + offset * SAMPLE_STORE_NUM_ELEMENTS,
+			   vectors, numCopy * SAMPLE_STORE_NUM_ELEMENTS * sizeof(double));
+
+		vectors += numCopy * SAMPLE_STORE_NUM_ELEMENTS;
+		numVectors -= numCopy;
+		store->count += numCopy;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Replace the contents of the store with a view of interleaved x, y, z
+// vectors owned by the caller, e.g. a mapped log. Only the block index is
+// allocated; the vectors must outlive the store. Returns -1 when out of memory.
+//-----------------------------------------------------------------------------
+int SampleStoreAttach (SampleStore *store, const double *vectors, size_t numVectors)
+{
+	size_t numBlocks;
+	size_t i;
+
+	SampleStoreFree (store);
+
+	numBlocks = (numVectors + SAMPLE_STORE_BLOCK_VECTORS - 1) / SAMPLE_STORE_BLOCK_VECTORS;
+	if (numBlocks == 0)
+		return 0;
+	store->blocks = (double**)malloc(numBlocks * sizeof(double*));
+	if (!store->blocks)
+		return -1;
+
+	// The store never writes through these pointers
+	for (i = 0; i < numBlocks; i++)
+		store->blocks[i] = (double*)(vectors + i * BLOCK_SIZE);
+	store->numBlocks = numBlocks;
+	store->indexSize = numBlocks;
+	store->count = numVectors;
+	store->external = 1;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Stable pointer to the x, y, z values of one vector
+//-----------------------------------------------------------------------------
+double *SampleStoreVector (const SampleStore *store, size_t index)
+{
+	return store->blocks[index / SAMPLE_STORE_BLOCK_VECTORS]
+		   + (index % SAMPLE_STORE_BLOCK_VECTORS) * SAMPLE_STORE_NUM_ELEMENTS;
+}
+
+//-----------------------------------------------------------------------------
+// Gather one axis (0 = x, 1 = y, 2 = z) of a range of vectors into a
+// contiguous array. Returns the number of values copied.
+//-----------------------------------------------------------------------------
+size_t SampleStoreCopyAxis (const SampleStore *store, int axis, size_t start, size_t count, double *dest)
+{
+	const double *source;
+	size_t i;
+
+	if (start >= store->count)
+		return 0;
+	if (count > store->count - start)
+		count = store->count - start;
+
+	source = SampleStoreVector (store, start) + axis;
+	for (i = 0; i < count; i++)
+	{
+		// Jump to the next block at a block boundary
+		if (i > 0 && (start + i) % SAMPLE_STORE_BLOCK_VECTORS == 0)
+			source = SampleStoreVector (store, start + i) + axis;
+		dest[i] = *source;
+		source += SAMPLE_STORE_NUM_ELEMENTS;
+	}
+	return count;
+}
@@ -0,0 +1,54 @@
+//==============================================================================
+// Title:		Append-only store of received x, y, z vectors.
+// Description:	Vectors are kept interleaved in fixed-size blocks that never
+//				move once allocated, so pointers returned by SampleStoreVector
+//				stay valid until the store is freed. Only the small block index
+//				grows (geometrically) as a capture gets longer, which keeps
+//				appends O(1) regardless of the recording length. Contiguous
+//				per-axis views for the FFT are gathered with SampleStoreCopyAxis.
+//				A store can also be attached to vectors that live elsewhere,
+//				such as a memory-mapped log; it is read-only then.
+//==============================================================================
+
+#ifndef SAMPLE_STORE_H
+#define SAMPLE_STORE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define SAMPLE_STORE_NUM_ELEMENTS	3 		// x, y, z vector
+#define SAMPLE_STORE_BLOCK_VECTORS	4096 	// Vectors per block (96 KiB)
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	double **blocks;		// Block index
+	size_t numBlocks;		// Blocks allocated
+	size_t indexSize;		// Capacity of the block index
+	size_t count;			// Vectors stored
+	int external;			// Blocks point into memory the store doesn't own
+} SampleStore;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+void SampleStoreInit (SampleStore *store);
+void SampleStoreFree (SampleStore *store);
+int SampleStoreAppend (SampleStore *store, const double *vectors, size_t numVectors);
+int SampleStoreAttach (SampleStore *store, const double *vectors, size_t numVectors);
+double *SampleStoreVector (const SampleStore *store, size_t index);
+size_t SampleStoreCopyAxis (const SampleStore *store, int axis, size_t start, size_t count, double *dest);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* SAMPLE_STORE_H */
@@ -0,0 +1,87 @@
+//==============================================================================
+// Title:		Batch of encoded frames waiting for room in an output queue.
+// Description:	See SendBatch.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include "SendBatch.h"
+
+//-----------------------------------------------------------------------------
+// Allocate an empty batch of capacity bytes. Returns -1 when out of memory.
+//-----------------------------------------------------------------------------
+int SendBatchInit (SendBatch *batch, size_t capacity)
+{
+	memset(batch, 0, sizeof(*batch));
+	batch->bytes = (unsigned char*)malloc(capacity);
+	if (!batch->bytes)
+		return -1;
+	batch->capacity = capacity;
+	return 0;
+}
+
+void SendBatchFree (SendBatch *batch)
+{
+	free(batch->bytes);
+	memset(batch, 0, sizeof(*batch));
+}
+
+//-----------------------------------------------------------------------------
+// Drop the waiting bytes, e.g. when the receiver is gone. The stall count
+// and time carry on.
+//-----------------------------------------------------------------------------
+void SendBatchClear (SendBatch *batch)
+{
+	batch->length = 0;
+	batch->stalled = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Encode frames at the tail, at most the room left, then commit their bytes
+//-----------------------------------------------------------------------------
+size_t SendBatchRoom (const SendBatch *batch)
+{
+	return batch->capacity - batch->length;
+}
+
+unsigned char *SendBatchTail (SendBatch *batch)
+{
+	return batch->bytes + batch->length;
+}
+
+void SendBatchCommit (SendBatch *batch, size_t numBytes)
+{
+	batch->length += numBytes;
+}
+
+//-----------------------------------------------------------------------------
+// Bytes to write from the head, given the room in the output queue, 0 while
+// flow control holds the link. Counts a stall when bytes wait and nothing
+// can go, and its time up to now.
+//-----------------------------------------------------------------------------
+size_t SendBatchWritable (SendBatch *batch, size_t room, double now)
+{
+	int stalled = batch->length > 0 && room == 0;
+
+	if (batch->stalled)
+		batch->stalledTime += now - batch->checkTime;
+	else if (stalled)
+		batch->stalls++;
+	batch->stalled = stalled;
+	batch->checkTime = now;
+	return batch->length < room ? batch->length : room;
+}
+
+//-----------------------------------------------------------------------------
+// Remove the bytes written, the rest moves to the head
+//-----------------------------------------------------------------------------
+void SendBatchConsume (SendBatch *batch, size_t numBytes)
+{
+	if (numBytes > batch->length)
+		numBytes = batch->length;
+	batch->length -= numBytes;
+	memmove(batch->bytes, batch->bytes + numBytes, batch->length);
+}
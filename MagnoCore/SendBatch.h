@@ -0,0 +1,51 @@
+//==============================================================================
+// Title:		Batch of encoded frames waiting for room in an output queue.
+// Description:	Frames are encoded straight into the batch and written in
+//				large chunks, never more than the output queue has room for,
+//				so a write neither blocks nor overflows the queue. What does
+//				not fit stays in the batch for the next write. While the link
+//				is held back, by CTS or XOFF flow control or simply by a full
+//				queue, nothing can be written; these stalls are counted and
+//				timed. Times are seconds on any monotonic clock.
+//==============================================================================
+
+#ifndef SEND_BATCH_H
+#define SEND_BATCH_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	unsigned char *bytes;
+	size_t capacity;
+	size_t length;				// Bytes waiting to be written
+	int stalled;				// Bytes waiting and no room at the last check
+	double checkTime;			// Time of the last check
+	unsigned int stalls;		// Times the batch could not be written at all
+	double stalledTime;			// Seconds spent stalled
+} SendBatch;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int SendBatchInit (SendBatch *batch, size_t capacity);
+void SendBatchFree (SendBatch *batch);
+void SendBatchClear (SendBatch *batch);
+size_t SendBatchRoom (const SendBatch *batch);
+unsigned char *SendBatchTail (SendBatch *batch);
+void SendBatchCommit (SendBatch *batch, size_t numBytes);
+size_t SendBatchWritable (SendBatch *batch, size_t room, double now);
+void SendBatchConsume (SendBatch *batch, size_t numBytes);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* SEND_BATCH_H */
@@ -0,0 +1,72 @@
+//==============================================================================
+// Title:		Lock-free latest-value handoff between two threads.
+// Description:	See Snapshot.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include "Snapshot.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define SNAPSHOT_FRESH	4 	// Flag next to the slot index: published, not yet taken
+
+//-----------------------------------------------------------------------------
+// Allocate three zeroed slots of size bytes. Returns -1 when out of memory.
+//-----------------------------------------------------------------------------
+int SnapshotInit (Snapshot *snapshot, size_t size)
+{
+	memset(snapshot, 0, sizeof(*snapshot));
+	snapshot->slots = (char*)calloc(3, size);
+	if (!snapshot->slots)
+		return -1;
+	snapshot->size = size;
+	snapshot->back = 0;
+	snapshot->shared = 1;
+	snapshot->front = 2;
+	return 0;
+}
+
+void SnapshotFree (Snapshot *snapshot)
+{
+	free(snapshot->slots);
+	memset(snapshot, 0, sizeof(*snapshot));
+}
+
+//-----------------------------------------------------------------------------
+// Zero every slot. Only while neither side is using the snapshot.
+//-----------------------------------------------------------------------------
+void SnapshotClear (Snapshot *snapshot)
+{
+	memset(snapshot->slots, 0, 3 * snapshot->size);
+	AtomicStore (&snapshot->shared, AtomicLoad (&snapshot->shared) & ~SNAPSHOT_FRESH);
+}
+
+//-----------------------------------------------------------------------------
+// Writer side. Fill the slot, then publish it. The slot handed out after a
+// publish holds an older snapshot, so fill every field.
+//-----------------------------------------------------------------------------
+void *SnapshotBack (Snapshot *snapshot)
+{
+	return snapshot->slots + snapshot->back * snapshot->size;
+}
+
+void SnapshotPublish (Snapshot *snapshot)
+{
+	snapshot->back = AtomicExchange (&snapshot->shared, snapshot->back | SNAPSHOT_FRESH) & ~SNAPSHOT_FRESH;
+}
+
+//-----------------------------------------------------------------------------
+// Reader side. Returns the latest published snapshot, or the previous one
+// again when nothing was published since. Valid until the next call.
+//-----------------------------------------------------------------------------
+const void *SnapshotLatest (Snapshot *snapshot)
+{
+	if (AtomicLoad (&snapshot->shared) & SNAPSHOT_FRESH)
+		snapshot->front = AtomicExchange (&snapshot->shared, snapshot->front) & ~SNAPSHOT_FRESH;
+	return snapshot->slots + snapshot->front * snapshot->size;
+}
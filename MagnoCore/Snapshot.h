@@ -0,0 +1,48 @@
+//==============================================================================
+// Title:		Lock-free latest-value handoff between two threads.
+// Description:	A triple buffer: the writer fills its own slot and publishes
+//				it by swapping it with the shared slot, the reader swaps the
+//				shared slot in whenever it is newer than its own. Neither
+//				side blocks or copies through the other, the writer may
+//				publish far more often than the reader looks, and the reader
+//				always gets the latest complete snapshot. Exactly one thread
+//				may write and one other thread may read.
+//==============================================================================
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include "MagnoAtomic.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	AtomicIndex shared;			// Slot between the sides, SNAPSHOT_FRESH when newer than the reader's
+	unsigned int back;			// Writer's slot
+	unsigned int front;			// Reader's slot
+	size_t size;				// Bytes per slot
+	char *slots;				// Three slots, zeroed at first
+} Snapshot;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int SnapshotInit (Snapshot *snapshot, size_t size);
+void SnapshotFree (Snapshot *snapshot);
+void SnapshotClear (Snapshot *snapshot);
+void *SnapshotBack (Snapshot *snapshot);
+void SnapshotPublish (Snapshot *snapshot);
+const void *SnapshotLatest (Snapshot *snapshot);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* SNAPSHOT_H */
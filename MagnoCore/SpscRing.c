@@ -0,0 +1,162 @@
+//==============================================================================
+// Title:		Lock-free single-producer, single-consumer ring buffer.
+// Description:	See SpscRing.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include "SpscRing.h"
+
+//-----------------------------------------------------------------------------
+// Allocate a ring of capacity items. Returns -1 when the capacity is not a
+// power of two or out of memory.
+//-----------------------------------------------------------------------------
+int SpscRingInit (SpscRing *ring, unsigned int capacity, size_t itemSize)
+{
+	memset(ring, 0, sizeof(*ring));
+	if (capacity == 0 || (capacity & (capacity - 1)))
+		return -1;
+
+	ring->items = (char*)malloc(capacity * itemSize);
+	if (!ring->items)
+		return -1;
+	ring->capacity = capacity;
+	ring->itemSize = itemSize;
+	return 0;
+}
+
+void SpscRingFree (SpscRing *ring)
+{
+	free(ring->items);
+	memset(ring, 0, sizeof(*ring));
+}
+
+//-----------------------------------------------------------------------------
+// Copy count items between a linear buffer and the ring starting at index,
+// splitting the copy where the ring wraps
+//-----------------------------------------------------------------------------
+static void CopyIn (SpscRing *ring, unsigned int index, const char *items, unsigned int count)
+{
+	unsigned int offset = index & (ring->capacity - 1);
+	unsigned int first = ring->capacity - offset;
+
+	if (first > count)
+		first = count;
+	memcpy(ring->items + offset * ring->itemSize, items, first * ring->itemSize);
+	memcpy(ring->items, items + first * ring->itemSize, (count - first) * ring->itemSize);
+}
+
+static void CopyOut (SpscRing *ring, unsigned int index, char *items, unsigned int count)
+{
+	unsigned int offset = index & (ring->capacity - 1);
+	unsigned int first = ring->capacity - offset;
+
+	if (first > count)
+		first = count;
+	memcpy(items, ring->items + offset * ring->itemSize, first * ring->itemSize);
+	memcpy(items + first * ring->itemSize, ring->items, (count - first) * ring->itemSize);
+}
+
+//-----------------------------------------------------------------------------
+// Free slots and queued items. The other side's counter is loaded only when
+// the last view of it doesn't satisfy the request.
+//-----------------------------------------------------------------------------
+static unsigned int Space (SpscRing *ring, unsigned int wanted)
+{
+	unsigned int head = ring->head;			// Only the producer writes head
+
+	if (ring->capacity - (head - ring->tailSeen) < wanted)
+		ring->tailSeen = AtomicLoad (&ring->tail);
+	return ring->capacity - (head - ring->tailSeen);
+}
+
+static unsigned int Queued (SpscRing *ring, unsigned int wanted)
+{
+	unsigned int tail = ring->tail;			// Only the consumer writes tail
+
+	if (ring->headSeen - tail < wanted)
+		ring->headSeen = AtomicLoad (&ring->head);
+	return ring->headSeen - tail;
+}
+
+//-----------------------------------------------------------------------------
+// Producer side. Returns the number of items written, less than count when
+// the ring is full.
+//-----------------------------------------------------------------------------
+unsigned int SpscRingWrite (SpscRing *ring, const void *items, unsigned int count)
+{
+	unsigned int space = Space (ring, count);
+
+	if (count > space)
+		count = space;
+	if (count == 0)
+		return 0;
+
+	CopyIn (ring, ring->head, (const char*)items, count);
+	AtomicStore (&ring->head, ring->head + count);	// Publish after the copy
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// Consumer side. Returns the number of items read, 0 when the ring is empty.
+//-----------------------------------------------------------------------------
+unsigned int SpscRingRead (SpscRing *ring, void *items, unsigned int maxCount)
+{
+	unsigned int count = Queued (ring, maxCount);
+
+	if (count > maxCount)
+		count = maxCount;
+	if (count == 0)
+		return 0;
+
+	CopyOut (ring, ring->tail, (char*)items, count);
+	AtomicStore (&ring->tail, ring->tail + count);	// Release the slots after the copy
+	return count;
+}
+
+//-----------------------------------------------------------------------------
+// Producer side, in place. Get up to *count free slots that are contiguous
+// in memory, fill them and publish how many were filled. *count is 0 when
+// the ring is full.
+//-----------------------------------------------------------------------------
+void *SpscRingReserve (SpscRing *ring, unsigned int *count)
+{
+	unsigned int offset = ring->head & (ring->capacity - 1);
+	unsigned int space = Space (ring, *count);
+
+	if (space > ring->capacity - offset)
+		space = ring->capacity - offset;	// Up to the end of the buffer
+	if (*count > space)
+		*count = space;
+	return ring->items + offset * ring->itemSize;
+}
+
+void SpscRingPublish (SpscRing *ring, unsigned int count)
+{
+	AtomicStore (&ring->head, ring->head + count);
+}
+
+//-----------------------------------------------------------------------------
+// Consumer side, in place. Get up to *count queued items that are
+// contiguous in memory, use them and consume how many were used. *count is
+// 0 when the ring is empty.
+//-----------------------------------------------------------------------------
+const void *SpscRingPeek (SpscRing *ring, unsigned int *count)
+{
+	unsigned int offset = ring->tail & (ring->capacity - 1);
+	unsigned int queued = Queued (ring, *count);
+
+	if (queued > ring->capacity - offset)
+		queued = ring->capacity - offset;	// Up to the end of the buffer
+	if (*count > queued)
+		*count = queued;
+	return ring->items + offset * ring->itemSize;
+}
+
+void SpscRingConsume (SpscRing *ring, unsigned int count)
+{
+	AtomicStore (&ring->tail, ring->tail + count);
+}
@@ -0,0 +1,69 @@
+//==============================================================================
+// Title:		Lock-free single-producer, single-consumer ring buffer.
+// Description:	Fixed-size items are passed in batches. Exactly one thread
+//				may write and one other thread may read; neither side ever
+//				blocks or takes a lock. The head and tail counters run freely
+//				and wrap, the capacity must be a power of two.
+//				Each side owns one cache line holding its counter and its
+//				last view of the other side's counter, so the two threads
+//				only touch each other's line when the ring looks full or
+//				empty. Items are either copied with SpscRingWrite and
+//				SpscRingRead, or produced and consumed in place: Reserve or
+//				Peek hand out the next contiguous run of slots, Publish or
+//				Consume release a batch of them at once.
+//==============================================================================
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include "MagnoAtomic.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define SPSC_RING_CACHE_LINE	64
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	// Producer's cache line
+	AtomicIndex head;			// Items written, advanced by the producer
+	unsigned int tailSeen;		// Producer's last load of tail
+	char producerPad[SPSC_RING_CACHE_LINE - sizeof(AtomicIndex) - sizeof(unsigned int)];
+
+	// Consumer's cache line
+	AtomicIndex tail;			// Items read, advanced by the consumer
+	unsigned int headSeen;		// Consumer's last load of head
+	char consumerPad[SPSC_RING_CACHE_LINE - sizeof(AtomicIndex) - sizeof(unsigned int)];
+
+	// Read-only after SpscRingInit
+	unsigned int capacity;		// Items, power of two
+	size_t itemSize;			// Bytes per item
+	char *items;
+} SpscRing;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int SpscRingInit (SpscRing *ring, unsigned int capacity, size_t itemSize);
+void SpscRingFree (SpscRing *ring);
+unsigned int SpscRingWrite (SpscRing *ring, const void *items, unsigned int count);
+unsigned int SpscRingRead (SpscRing *ring, void *items, unsigned int maxCount);
+
+void *SpscRingReserve (SpscRing *ring, unsigned int *count);
+void SpscRingPublish (SpscRing *ring, unsigned int count);
+const void *SpscRingPeek (SpscRing *ring, unsigned int *count);
+void SpscRingConsume (SpscRing *ring, unsigned int count);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* SPSC_RING_H */
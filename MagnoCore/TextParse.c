@@ -0,0 +1,140 @@
+//==============================================================================
+// Title:		Bounded number parsing for memory-mapped text.
+// Description:	See TextParse.h. Every parser returns the position after what
+//				it consumed, or NULL when no number starts at the cursor.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "TextParse.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define MAX_EXACT_DIGITS	15 	// Digits that always fit a double's mantissa
+#define MAX_EXACT_POWER		22 	// Largest power of ten that is exact in a double
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static const double powersOfTen[MAX_EXACT_POWER + 1] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//-----------------------------------------------------------------------------
+// Skip spaces and tabs, but not line ends
+//-----------------------------------------------------------------------------
+const char *SkipBlanks (const char *cursor, const char *end)
+{
+	while (cursor < end && (*cursor == ' ' || *cursor == '\t'))
+		cursor++;
+	return cursor;
+}
+
+//-----------------------------------------------------------------------------
+// Move past the next line end
+//-----------------------------------------------------------------------------
+const char *SkipLine (const char *cursor, const char *end)
+{
+	if (cursor >= end || !(cursor = (const char*)memchr(cursor, '\n', (size_t)(end - cursor))))
+		return end;
+	return cursor + 1;
+}
+
+const char *ParseUnsigned (const char *cursor, const char *end, unsigned int *value)
+{
+	const char *start = cursor;
+	unsigned int result = 0;
+
+	while (cursor < end && *cursor >= '0' && *cursor <= '9')
+		result = result * 10 + (unsigned int)(*cursor++ - '0');
+	if (cursor == start)
+		return NULL;
+	*value = result;
+	return cursor;
+}
+
+//-----------------------------------------------------------------------------
+// Parse [+-]digits[.digits][(e|E)[+-]digits]
+//-----------------------------------------------------------------------------
+const char *ParseDouble (const char *cursor, const char *end, double *value)
+{
+	unsigned long long mantissa = 0;
+	double result;
+	int numDigits = 0;			// Significant digits kept in mantissa
+	int exponent = 0;			// Decimal exponent applied to mantissa
+	int expSign = 1;
+	int expValue = 0;
+	int negative = 0;
+	int seenDigit = 0;
+
+	if (cursor < end && (*cursor == '-' || *cursor == '+'))
+		negative = *cursor++ == '-';
+
+	// Integer part, digits beyond the exact range only scale the result
+	for (; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++, seenDigit = 1)
+	{
+		if (numDigits < 19)
+		{
+			mantissa = mantissa * 10 + (unsigned long long)(*cursor - '0');
+			numDigits += mantissa != 0;
+		}
+		else
+			exponent++;
+	}
+
+	// Fraction part
+	if (cursor < end && *cursor == '.')
+	{
+		for (cursor++; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++, seenDigit = 1)
+		{
+			if (numDigits < 19)
+			{
+				mantissa = mantissa * 10 + (unsigned long long)(*cursor - '0');
+				numDigits += mantissa != 0;
+				exponent--;
+			}
+		}
+	}
+	if (!seenDigit)
+		return NULL;
+
+	// Exponent part
+	if (cursor < end && (*cursor == 'e' || *cursor == 'E'))
+	{
+		const char *mark = cursor++;
+
+		if (cursor < end && (*cursor == '-' || *cursor == '+'))
+			expSign = *cursor++ == '-' ? -1 : 1;
+		if (cursor < end && *cursor >= '0' && *cursor <= '9')
+		{
+			for (; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++)
+				if (expValue < 10000)
+					expValue = expValue * 10 + (*cursor - '0');
+			exponent += expSign * expValue;
+		}
+		else
+			cursor = mark; // Not an exponent, leave the 'e' alone
+	}
+
+	result = (double)mantissa;
+	if (numDigits <= MAX_EXACT_DIGITS && exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER)
+	{
+		// Both operands are exact, so the single rounding is correct
+		if (exponent < 0)
+			result /= powersOfTen[-exponent];
+		else
+			result *= powersOfTen[exponent];
+	}
+	else
+		result *= pow(10.0, exponent);
+
+	*value = negative ? -result : result;
+	return cursor;
+}
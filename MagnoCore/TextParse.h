@@ -0,0 +1,30 @@
+//==============================================================================
+// Title:		Bounded number parsing for memory-mapped text.
+// Description:	Mapped files are not NUL terminated, so the C library's
+//				strtod and sscanf can't be used on them safely. These parsers
+//				stop at an explicit end pointer. Decimal numbers with up to
+//				15 significant digits and small exponents are converted with
+//				a single exact multiplication or division, which gives the
+//				correctly rounded double.
+//==============================================================================
+
+#ifndef TEXT_PARSE_H
+#define TEXT_PARSE_H
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+const char *SkipBlanks (const char *cursor, const char *end);
+const char *SkipLine (const char *cursor, const char *end);
+const char *ParseDouble (const char *cursor, const char *end, double *value);
+const char *ParseUnsigned (const char *cursor, const char *end, unsigned int *value);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* TEXT_PARSE_H */
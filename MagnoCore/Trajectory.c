@@ -0,0 +1,84 @@
+//==============================================================================
+// Title:		Bounded, decimated trajectory of the field vector.
+// Description:	See Trajectory.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <string.h>
+#include "Trajectory.h"
+
+//-----------------------------------------------------------------------------
+// Empty the trajectory and size its decimation so that capacity points span
+// the last seconds of vectors arriving at fs
+//-----------------------------------------------------------------------------
+void TrajectoryReset (Trajectory *trajectory, double fs, double seconds, size_t capacity)
+{
+	double decimation;
+
+	if (capacity == 0 || capacity > TRAJECTORY_MAX_POINTS)
+		capacity = TRAJECTORY_MAX_POINTS;
+	decimation = ceil(fs * seconds / capacity);
+
+	trajectory->capacity = capacity;
+	trajectory->count = 0;
+	trajectory->next = 0;
+	trajectory->decimation = decimation >= 1.0 ? (size_t)decimation : 1;
+	trajectory->filled = 0;
+	memset(trajectory->sum, 0, sizeof(trajectory->sum));
+	trajectory->total = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Add interleaved x, y, z vectors. Each completed group of decimation vectors
+// becomes one point, overwriting the oldest once the ring is full.
+//-----------------------------------------------------------------------------
+void TrajectoryAppend (Trajectory *trajectory, const double *vectors, size_t numVectors)
+{
+	size_t i;
+	int axis;
+
+	for (i = 0; i < numVectors; i++, vectors += TRAJECTORY_NUM_ELEMENTS)
+	{
+		for (axis = 0; axis < TRAJECTORY_NUM_ELEMENTS; axis++)
+			trajectory->sum[axis] += vectors[axis];
+		if (++trajectory->filled < trajectory->decimation)
+			continue;
+
+		for (axis = 0; axis < TRAJECTORY_NUM_ELEMENTS; axis++)
+		{
+			trajectory->points[axis][trajectory->next] = trajectory->sum[axis] / trajectory->filled;
+			trajectory->sum[axis] = 0.0;
+		}
+		trajectory->filled = 0;
+		trajectory->total++;
+		if (++trajectory->next == trajectory->capacity)
+			trajectory->next = 0;
+		if (trajectory->count < trajectory->capacity)
+			trajectory->count++;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Copy one axis of the points, oldest first, into dest, which must hold
+// capacity values. Returns the number of points copied.
+//-----------------------------------------------------------------------------
+size_t TrajectoryCopyAxis (const Trajectory *trajectory, int axis, double *dest)
+{
+	const double *points = trajectory->points[axis];
+	size_t oldest;
+	size_t first;
+
+	if (trajectory->count == 0)
+		return 0;
+
+	oldest = (trajectory->next + trajectory->capacity - trajectory->count) % trajectory->capacity;
+	first = trajectory->capacity - oldest;
+	if (first > trajectory->count)
+		first = trajectory->count;
+	memcpy(dest, points + oldest, first * sizeof(double));
+	memcpy(dest + first, points, (trajectory->count - first) * sizeof(double));
+	return trajectory->count;
+}
@@ -0,0 +1,52 @@
+//==============================================================================
+// Title:		Bounded, decimated trajectory of the field vector.
+// Description:	Keeps the path of the field vector over the last stretch of
+//				a capture for 3D display. Every decimation vectors are
+//				averaged into one point and the points go into a ring of at
+//				most TRAJECTORY_MAX_POINTS per axis, so appending costs the
+//				same whatever the capture length and the curve handed to the
+//				graph never grows past the ring.
+//==============================================================================
+
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define TRAJECTORY_NUM_ELEMENTS	3 		// x, y, z vector
+#define TRAJECTORY_MAX_POINTS	2048 	// Points kept per axis
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	double points[TRAJECTORY_NUM_ELEMENTS][TRAJECTORY_MAX_POINTS];	// Ring, per axis
+	size_t capacity;			// Points kept, up to TRAJECTORY_MAX_POINTS
+	size_t count;				// Points in the ring
+	size_t next;				// Ring slot of the next point
+	size_t decimation;			// Vectors averaged per point
+	size_t filled;				// Vectors in the open point
+	double sum[TRAJECTORY_NUM_ELEMENTS];	// Of the open point's vectors
+	unsigned long total;		// Points appended since the reset, tells a new frame apart
+} Trajectory;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+void TrajectoryReset (Trajectory *trajectory, double fs, double seconds, size_t capacity);
+void TrajectoryAppend (Trajectory *trajectory, const double *vectors, size_t numVectors);
+size_t TrajectoryCopyAxis (const Trajectory *trajectory, int axis, double *dest);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* TRAJECTORY_H */
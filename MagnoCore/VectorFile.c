@@ -0,0 +1,162 @@
+//==============================================================================
+// Title:		Bulk loader for files of x, y, z vectors.
+// Description:	See VectorFile.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include "VectorFile.h"
+#include "TextParse.h"
+
+//-----------------------------------------------------------------------------
+// Count the lines of the text, a last line without a newline included
+//-----------------------------------------------------------------------------
+static size_t CountLines (const char *cursor, const char *end)
+{
+	size_t numLines = 0;
+
+	while (cursor < end)
+	{
+		cursor = (const char*)memchr(cursor, '\n', (size_t)(end - cursor));
+		numLines++;
+		if (!cursor)
+			break;
+		cursor++;
+	}
+	return numLines;
+}
+
+//-----------------------------------------------------------------------------
+// Skip the "HH:MM:SS" time of a text log row. Returns NULL when the row
+// doesn't start with one.
+//-----------------------------------------------------------------------------
+static const char *SkipTime (const char *cursor, const char *end)
+{
+	unsigned int field;
+
+	if (!(cursor = ParseUnsigned (cursor, end, &field)) || cursor >= end || *cursor++ != ':'
+		|| !(cursor = ParseUnsigned (cursor, end, &field)) || cursor >= end || *cursor++ != ':'
+		|| !(cursor = ParseUnsigned (cursor, end, &field)))
+		return NULL;
+	return cursor;
+}
+
+//-----------------------------------------------------------------------------
+// Parse the x, y, z values of one row into vector. Returns the position
+// after them, or NULL when the row holds no whole vector.
+//-----------------------------------------------------------------------------
+static const char *ParseRow (const char *cursor, const char *end, int timed, double *vector)
+{
+	int i;
+
+	cursor = SkipBlanks (cursor, end);
+	if (timed && !(cursor = SkipTime (cursor, end)))
+		return NULL;
+
+	for (i = 0; i < VECTOR_FILE_NUM_ELEMENTS; i++)
+	{
+		cursor = SkipBlanks (cursor, end);
+		if (!(cursor = ParseDouble (cursor, end, &vector[i])))
+			return NULL;
+	}
+	return cursor;
+}
+
+//-----------------------------------------------------------------------------
+// Parse a mapped text file. The first row holding a vector decides whether
+// rows carry a time.
+//-----------------------------------------------------------------------------
+static int ParseText (VectorFile *vectorFile, const MappedFile *text)
+{
+	const char *cursor = text->data;
+	const char *end = text->data + text->size;
+	const char *rowEnd;
+	double *vector;
+	size_t numVectors = 0;
+	int timed = -1;
+
+	// Every vector takes a line, so the line count bounds the buffer
+	vectorFile->buffer = (double*)malloc((CountLines (cursor, end) + 1) * VECTOR_FILE_NUM_ELEMENTS * sizeof(double));
+	if (!vectorFile->buffer)
+		return MAGNO_LOG_ERROR_FILE;
+
+	for (vector = vectorFile->buffer; cursor < end; cursor = SkipLine (rowEnd, end))
+	{
+		if (timed < 0)
+		{
+			if ((rowEnd = ParseRow (cursor, end, 1, vector)))
+				timed = 1;
+			else if ((rowEnd = ParseRow (cursor, end, 0, vector)))
+				timed = 0;
+		}
+		else
+			rowEnd = ParseRow (cursor, end, timed, vector);
+
+		// The rest of the row is skipped from where parsing stopped
+		if (!rowEnd)
+		{
+			rowEnd = cursor;
+			continue;
+		}
+		vector += VECTOR_FILE_NUM_ELEMENTS;
+		numVectors++;
+	}
+
+	if (numVectors == 0)
+		return MAGNO_LOG_ERROR_FORMAT;
+
+	vectorFile->format = timed ? VECTOR_FILE_TEXT_LOG : VECTOR_FILE_TEXT;
+	vectorFile->vectors = vectorFile->buffer;
+	vectorFile->numVectors = numVectors;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Load the vectors of a file in any supported format. Returns 0, or one of
+// the MAGNO_LOG_ERROR values.
+//-----------------------------------------------------------------------------
+int VectorFileOpen (VectorFile *vectorFile, const char *pathname)
+{
+	MappedFile text;
+	int error;
+
+	memset(vectorFile, 0, sizeof(*vectorFile));
+
+	if (MappedFileOpen (&text, pathname) < 0)
+		return MAGNO_LOG_ERROR_FILE;
+
+	// Binary logs are used in place, from a mapping of their own
+	if (text.size >= sizeof(MagnoLogHeader) && memcmp(text.data, MAGNO_LOG_MAGIC, strlen(MAGNO_LOG_MAGIC)) == 0)
+	{
+		MappedFileClose (&text);
+		error = MagnoLogOpen (&vectorFile->log, pathname);
+		if (error < 0)
+			return error;
+		if (vectorFile->log.numVectors == 0)
+		{
+			VectorFileClose (vectorFile);
+			return MAGNO_LOG_ERROR_FORMAT;
+		}
+		vectorFile->format = VECTOR_FILE_BINARY_LOG;
+		vectorFile->vectors = vectorFile->log.vectors;
+		vectorFile->numVectors = vectorFile->log.numVectors;
+		vectorFile->fs = vectorFile->log.header.fs;
+		return 0;
+	}
+
+	error = ParseText (vectorFile, &text);
+	MappedFileClose (&text);
+	if (error < 0)
+		VectorFileClose (vectorFile);
+	return error;
+}
+
+void VectorFileClose (VectorFile *vectorFile)
+{
+	MagnoLogClose (&vectorFile->log);
+	free(vectorFile->buffer);
+	memset(vectorFile, 0, sizeof(*vectorFile));
+}
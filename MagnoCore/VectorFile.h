@@ -0,0 +1,60 @@
+//==============================================================================
+// Title:		Bulk loader for files of x, y, z vectors.
+// Description:	Opens a file of vectors in any of the formats the programs
+//				use and presents it as one interleaved array of doubles:
+//				 - a binary log (MagnoLog.h), mapped and used in place;
+//				 - the receiver's text log, "HH:MM:SS x y z" rows;
+//				 - plain text, "x y z" rows, such as the transmitter's Data.txt.
+//				The format is detected from the content. Text is mapped and
+//				parsed in one pass into a buffer sized from its row count, so
+//				loading is bound by the disk rather than by the C library's
+//				formatted input. Rows that don't hold a whole vector, such as
+//				headings, are skipped.
+//==============================================================================
+
+#ifndef VECTOR_FILE_H
+#define VECTOR_FILE_H
+
+#include <stddef.h>
+#include "MagnoLog.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define VECTOR_FILE_NUM_ELEMENTS	MAGNO_LOG_NUM_ELEMENTS 	// x, y, z vector
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef enum
+{
+	VECTOR_FILE_TEXT,				// "x y z" rows
+	VECTOR_FILE_TEXT_LOG,			// "HH:MM:SS x y z" rows
+	VECTOR_FILE_BINARY_LOG			// MagnoLog binary log
+} VectorFileFormat;
+
+typedef struct
+{
+	VectorFileFormat format;
+	const double *vectors;			// Interleaved x, y, z
+	size_t numVectors;
+	double fs;						// Recorded sampling rate, 0 when the format has none
+	MagnoLogReader log;				// Mapping of a binary log, vectors point into it
+	double *buffer;					// Vectors parsed from text
+} VectorFile;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int VectorFileOpen (VectorFile *vectorFile, const char *pathname);
+void VectorFileClose (VectorFile *vectorFile);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* VECTOR_FILE_H */
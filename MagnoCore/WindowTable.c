@@ -0,0 +1,105 @@
+//==============================================================================
+// Title:		Cached window coefficient tables for spectral analysis.
+// Description:	See WindowTable.h. All windows are periodic cosine sums,
+//				w[i] = a0 - a1 cos(2 pi i / N) + a2 cos(4 pi i / N) - ...
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "WindowTable.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define MAX_TERMS	5
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static const double windowTerms[WINDOW_NUM_TYPES][MAX_TERMS] =
+{
+	{ 0.54, 0.46 },										// Hamming
+	{ 0.5, 0.5 },										// Hann
+	{ 0.35875, 0.48829, 0.14128, 0.01168 },				// Blackman-Harris, 4 term
+	{ 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 } // Flat top
+};
+
+static const char *windowNames[WINDOW_NUM_TYPES] =
+{
+	"Hamming",
+	"Hann",
+	"Blackman-Harris",
+	"Flat top"
+};
+
+static void FillTable (WindowTable *table)
+{
+	const double *a = windowTerms[table->type];
+	double step = 2.0 * 3.14159265358979323846 / table->length;
+	double w;
+	size_t i;
+	int k;
+
+	table->sum = 0.0;
+	table->sumOfSquares = 0.0;
+	for (i = 0; i < table->length; i++)
+	{
+		for (k = 0, w = 0.0; k < MAX_TERMS; k++)
+			w += (k % 2 ? -a[k] : a[k]) * cos(k * step * i);
+		table->coefficients[i] = w;
+		table->sum += w;
+		table->sumOfSquares += w * w;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Get the coefficient table for a window, computing it on first use.
+// Returns NULL when out of memory.
+//-----------------------------------------------------------------------------
+const WindowTable *WindowCacheGet (WindowCache *cache, WindowType type, size_t length)
+{
+	WindowTable *table;
+	WindowTable *oldest = cache->tables;
+	int i;
+
+	for (i = 0; i < WINDOW_CACHE_SIZE; i++)
+	{
+		table = cache->tables + i;
+		if (table->coefficients && table->type == type && table->length == length)
+		{
+			table->lastUse = ++cache->useCount;
+			return table;
+		}
+		if (!table->coefficients || (oldest->coefficients && table->lastUse < oldest->lastUse))
+			oldest = table;
+	}
+
+	// Not cached, replace the least recently used table
+	free(oldest->coefficients);
+	oldest->coefficients = (double*)malloc(length * sizeof(double));
+	if (!oldest->coefficients)
+		return NULL;
+	oldest->type = type;
+	oldest->length = length;
+	oldest->lastUse = ++cache->useCount;
+	FillTable (oldest);
+	return oldest;
+}
+
+void WindowCacheFree (WindowCache *cache)
+{
+	int i;
+
+	for (i = 0; i < WINDOW_CACHE_SIZE; i++)
+		free(cache->tables[i].coefficients);
+	memset(cache, 0, sizeof(*cache));
+}
+
+const char *WindowTypeName (WindowType type)
+{
+	return windowNames[type];
+}
@@ -0,0 +1,61 @@
+//==============================================================================
+// Title:		Cached window coefficient tables for spectral analysis.
+// Description:	Window coefficients are computed once per window type and
+//				length and kept in a small least-recently-used cache, so
+//				repeated transforms of the same length only multiply.
+//==============================================================================
+
+#ifndef WINDOW_TABLE_H
+#define WINDOW_TABLE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define WINDOW_CACHE_SIZE	8
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef enum
+{
+	WINDOW_HAMMING,
+	WINDOW_HANN,
+	WINDOW_BLACKMAN_HARRIS,
+	WINDOW_FLAT_TOP,
+	WINDOW_NUM_TYPES
+} WindowType;
+
+typedef struct
+{
+	WindowType type;
+	size_t length;
+	double *coefficients;
+	double sum;					// Coherent gain times length, for amplitude correction
+	double sumOfSquares;		// Noise power gain times length, for density scaling
+	unsigned int lastUse;
+} WindowTable;
+
+typedef struct
+{
+	WindowTable tables[WINDOW_CACHE_SIZE];
+	unsigned int useCount;
+} WindowCache;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+const WindowTable *WindowCacheGet (WindowCache *cache, WindowType type, size_t length);
+void WindowCacheFree (WindowCache *cache);
+const char *WindowTypeName (WindowType type);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* WINDOW_TABLE_H */
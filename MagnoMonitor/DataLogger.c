@@ -0,0 +1,122 @@
+//==============================================================================
+// Title:		Asynchronous binary data logger.
+// Description:	See DataLogger.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <utility.h>
+#include <ansi_c.h>
+#include "DataLogger.h"
+#include "MagnoLog.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define IDLE_WAIT	0.01 	// Seconds to wait when the ring is empty
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+static int CVICALLBACK LoggerThreadFunction (void *functionData);
+
+//-----------------------------------------------------------------------------
+// Create the log file and start the writer thread. Returns -1 when the file
+// can't be created or out of memory.
+//-----------------------------------------------------------------------------
+int DataLoggerOpen (DataLogger *logger, const char *pathname, double fs, double startTime)
+{
+	if (SpscRingInit (&logger->ring, DATA_LOGGER_RING_VECTORS, MAGNO_LOG_RECORD_SIZE) < 0)
+		return -1;
+
+	logger->file = fopen (pathname, "wb");
+	if (!logger->file)
+	{
+		SpscRingFree (&logger->ring);
+		return -1;
+	}
+	setvbuf (logger->file, NULL, _IOFBF, DATA_LOGGER_FILE_BUFFER);
+
+	logger->overruns = 0;
+	logger->fs = fs;
+	logger->startTime = startTime;
+	logger->writeError = MagnoLogWriteHeader (logger->file, fs, startTime) < 0;
+
+	AtomicStore (&logger->running, 1);
+	CmtScheduleThreadPoolFunction (DEFAULT_THREAD_POOL_HANDLE, LoggerThreadFunction, logger,
+								   &logger->threadFunctionId);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Called from the thread that consumes the received vectors. Never blocks,
+// vectors that don't fit in the ring are counted as overruns.
+//-----------------------------------------------------------------------------
+void DataLoggerWrite (DataLogger *logger, const double *vectors, int numVectors)
+{
+	unsigned int numWritten;
+
+	if (!logger->file)
+		return;
+
+	numWritten = SpscRingWrite (&logger->ring, vectors, numVectors);
+	logger->overruns += numVectors - numWritten;
+}
+
+//-----------------------------------------------------------------------------
+// Let the writer thread drain the ring, then close the file. The header is
+// rewritten with fs and startTime, which the caller may have corrected from
+// the measured rate meanwhile. The caller must make sure DataLoggerWrite is
+// not running concurrently.
+//-----------------------------------------------------------------------------
+void DataLoggerClose (DataLogger *logger)
+{
+	if (!logger->file)
+		return;
+
+	AtomicStore (&logger->running, 0);
+	CmtWaitForThreadPoolFunctionCompletion (DEFAULT_THREAD_POOL_HANDLE, logger->threadFunctionId,
+											OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	CmtReleaseThreadPoolFunctionID (DEFAULT_THREAD_POOL_HANDLE, logger->threadFunctionId);
+	logger->threadFunctionId = 0;
+
+	if (fseek (logger->file, 0, SEEK_SET) != 0 || MagnoLogWriteHeader (logger->file, logger->fs, logger->startTime) < 0)
+		logger->writeError = 1;
+	if (fclose (logger->file) != 0)
+		logger->writeError = 1;
+	logger->file = NULL;
+	SpscRingFree (&logger->ring);
+}
+
+//-----------------------------------------------------------------------------
+// Writer thread: move the ring to the file in chunks until stopped and empty
+//-----------------------------------------------------------------------------
+static int CVICALLBACK LoggerThreadFunction (void *functionData)
+{
+	DataLogger *logger = functionData;
+	const void *vectors;
+	unsigned int numRead;
+	int stopping;
+
+	for (;;)
+	{
+		// Check for a stop before reading, so the last read sees every vector
+		stopping = !AtomicLoad (&logger->running);
+
+		// Write straight from the ring, no copy into a chunk
+		numRead = DATA_LOGGER_CHUNK_VECTORS;
+		vectors = SpscRingPeek (&logger->ring, &numRead);
+		if (numRead)
+		{
+			if (fwrite (vectors, MAGNO_LOG_RECORD_SIZE, numRead, logger->file) != numRead)
+				logger->writeError = 1;
+			SpscRingConsume (&logger->ring, numRead);
+		}
+		else if (stopping)
+			break;
+		else
+			Delay (IDLE_WAIT);
+	}
+	return 0;
+}
@@ -0,0 +1,53 @@
+//==============================================================================
+// Title:		Asynchronous binary data logger.
+// Description:	The receive path hands received vectors to a lock-free ring
+//				and returns at once. A thread-pool function drains the ring
+//				and writes the vectors to a binary log (see MagnoLog.h) in
+//				large buffered chunks, so disk I/O never stalls acquisition.
+//==============================================================================
+
+#ifndef DATA_LOGGER_H
+#define DATA_LOGGER_H
+
+#include <utility.h>
+#include <ansi_c.h>
+#include "SpscRing.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define DATA_LOGGER_RING_VECTORS	65536 			// Power of two
+#define DATA_LOGGER_CHUNK_VECTORS	4096 			// Vectors per fwrite at most
+#define DATA_LOGGER_FILE_BUFFER		(1024 * 1024)
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	SpscRing ring;
+	FILE *file;
+	CmtThreadFunctionID threadFunctionId;
+	AtomicIndex running;
+	unsigned int overruns;		// Vectors lost because the ring was full
+	int writeError;
+	double fs;					// Written to the header again at close
+	double startTime;
+} DataLogger;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int DataLoggerOpen (DataLogger *logger, const char *pathname, double fs, double startTime);
+void DataLoggerWrite (DataLogger *logger, const double *vectors, int numVectors);
+void DataLoggerClose (DataLogger *logger);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* DATA_LOGGER_H */
@@ -13,7 +13,6 @@
 //-----------------------------------------------------------------------------
 #include <cviauto.h>
 #include "cw3dgrph.h"
-#include <analysis.h>
 #include <utility.h>
 #include <rs232.h>
 #include <ansi_c.h>
@@ -21,32 +20,89 @@
 #include <userint.h>
 #include "MagnoMonitor.h"
 #include "ComConfigDLL.h"
+#include "Acquisition.h"
+#include "SampleStore.h"
+#include "FftEngine.h"
+#include "Spectrogram.h"
+#include "DataLogger.h"
+#include "MagnoLog.h"
+#include "SpscRing.h"
+#include "Snapshot.h"
+#include "Envelope.h"
+#include "Trajectory.h"
 
 //-----------------------------------------------------------------------------
 // Defines
 //-----------------------------------------------------------------------------
-#define NUM_ELEMENTS	3 								// x, y, z vector
-#define DATA_SIZE 		(sizeof(double) * NUM_ELEMENTS) // size of x, y, z vector
-#define PACKET_SIZE  	(DATA_SIZE + 1) 				// Include space for the checksum byte
+#define NUM_ELEMENTS	FRAME_NUM_ELEMENTS 				// x, y, z vector
+#define DATA_SIZE 		FRAME_VECTOR_SIZE 				// size of x, y, z vector
 
 #define NUM_VECTORS 					16
-#define MAX_ITEMS_IN_QUEUE_READ_BLOCK 	(NUM_VECTORS * DATA_SIZE)
-#define MAX_ITEMS_IN_QUEUE 				(1000 * MAX_ITEMS_IN_QUEUE_READ_BLOCK)
+#define MAX_VECTORS_PER_READ			(16 * NUM_VECTORS) // Vectors decoded per ring publish
+#define VECTOR_RING_SIZE				65536 			// Vectors buffered for the UI thread, power of two
 
-#define TIME_FORMAT_STRING	"%H:%M:%S"
+#define RECEIVE_IDLE	0 	// The com callback may decode
+#define RECEIVE_BUSY	1 	// The com callback is decoding
+#define RECEIVE_PAUSED	2 	// The UI thread is resetting the receive path
+#define RECEIVE_WAIT	0.001 	// Seconds between checks for the decoding to finish
+
+#define RATE_TOLERANCE	1e-3 	// Relative rate change that rescales the strip chart
+#define REFRESH_INTERVAL	(1.0 / 30) 	// Seconds between display refreshes while acquiring
+#define CHART_CHUNK			4096 		// Magnitudes decimated per strip chart update at most
+
+#define TRAJECTORY_SECONDS		10.0 	// Span of the 3D trajectory
+#define TRAJECTORY_POINTS		1000 	// Points of the 3D trajectory, up to TRAJECTORY_MAX_POINTS
+#define TRAJECTORY_INTERVAL		0.1 	// Seconds between 3D trajectory frames
+
+#define SPECTRUM_AMPLITUDE	0 	// Whole-record amplitude spectrum
+#define SPECTRUM_WELCH_PSD	1 	// Welch averaged spectral density
+
+#define REPLAY_INTERVAL			0.05 	// Seconds between replay timer ticks
+#define REPLAY_MAX_SPEED		1000.0 	// Replay speed limit, times real time
+#define REPLAY_MAX_VECTORS		65536 	// Vectors plotted per replay tick at most
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	double vector[NUM_ELEMENTS];	// Latest vector
+	double magnitude;
+	double min;
+	double max;
+	unsigned int count;				// Vectors decoded
+	unsigned int framesDropped;
+	unsigned int missing;
+	unsigned int interpolated;		// Vectors made up for lost frames
+	double rate;					// Measured from the sender's timestamps, 0 until known
+} AcquisitionState;
 
 //-----------------------------------------------------------------------------
 // Prototypes
 //-----------------------------------------------------------------------------
 void CVICALLBACK ComCallback (int portNumber, int eventMask, void *callbackData);
 static int CVICALLBACK ReadDataThreadFunction (void *functionData);
+static void ResetReceive (void);
+static void DrainRing (SpscRing *ring);
 void ToggleConnectLED();
-static void CVICALLBACK ProcessDataFromQueueCallback(CmtTSQHandle queueHandle, unsigned int event, int value, void *callbackData);
+void CreateControls();
+static int CVICALLBACK RefreshTimerCallback (int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
+void ProcessVectors();
+void RefreshIndicators();
 void StripChartTimeAxis();
-void VisualizeData();
+void StripChartScale(double rate);
+void PlotMagnitudes(const double *magnitudes, size_t numMagnitudes);
+void VisualizeData(size_t last, int force);
+void ShowTableRows(size_t first);
+static int CVICALLBACK TableScrollCallback (int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
 void CalculateFourierTransform();
 void FreeDataArrays();
 void WriteToFile();
+void CloseLogFile();
+void OpenLog(const char *path);
+void CloseReplay();
+static int CVICALLBACK OpenLogCallback (int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
+static int CVICALLBACK ReplayTimerCallback (int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
 
 //-----------------------------------------------------------------------------
 // Global variables
@@ -56,25 +112,48 @@ int	tabHandle_LiveChart;
 int tabHandle_3DGraph;
 int tabHandle_FFT;
 int plotHandleFFT;
+int droppedIndicator;
+int missingIndicator;
+int interpolatedIndicator;
+int rateIndicator;
+int windowRing;
+int spectrumRing;
+int segmentsIndicator;
+int spectrogramGraph;
+int openLogButton;
+int replaySpeedControl;
+int replayTimer;
+int refreshTimer;
+int tableScroll;
+int followLatest;
 int writeToFile;
 char dirname[MAX_PATHNAME_LEN];
 char pathname[MAX_PATHNAME_LEN];
-char *dateTimeBuffer;
 double startTime;
 double deltaTime;
-FILE *filehandle;
 CmtThreadFunctionID threadFunctionId;
-CmtThreadLockHandle lock;
-CmtTSQHandle tsqHandle;
+SpscRing vectorRing; // Decoded vectors, serial thread to UI thread
+SpscRing magnitudeRing; // Their magnitudes, in step with vectorRing
+Snapshot stateSnapshot; // Latest AcquisitionState, serial thread to UI thread
+AtomicIndex receiveGate; // RECEIVE_*, who owns the receive path
 CAObjHandle graphHandle;
 CAObjHandle plotHandle;
 CAObjHandle plotsHandle;
+Acquisition acquisition; // Frame decoding and magnitude statistics
+double latest[NUM_ELEMENTS]; // Last vector decoded, kept for callbacks that decode nothing
+double latestMagnitude;
 
 double fs; // Sampling rate
-double* x = NULL;
-double* y = NULL;
-double* z = NULL;
-unsigned int shift; // The number of vectors received
+double chartRate; // Sampling rate the strip chart time axis uses
+Envelope chartEnvelope; // Decimates magnitudes to min/max pairs per strip chart column
+Trajectory trajectory; // Recent path of the field vector for the 3D graph
+SampleStore store; // All x, y, z vectors received
+FftEngine fftEngine;
+Spectrogram spectrogram;
+DataLogger logger;
+MagnoLogReader logReader; // Log mapped for replay and offline analysis
+size_t replayPosition; // Vectors of the log already replayed
+double replayBacklog; // Vectors due but not yet replayed
 
 //-----------------------------------------------------------------------------
 // Program entry-point
@@ -98,9 +177,13 @@ int main (int argc, char *argv[])
 
 	// Display default directory and filename
 	GetProjectDir (dirname);
-	MakePathname (dirname, "DataFile.txt", pathname);
+	MakePathname (dirname, "DataFile" MAGNO_LOG_EXTENSION, pathname);
 	SetCtrlVal (tabHandle_LiveChart, TABPANEL_PATH, pathname);
 
+	AcquisitionInit (&acquisition);
+	CreateControls();
+	SpectrogramInit (&spectrogram, tabHandle_FFT, spectrogramGraph);
+
 	DisplayPanel (panelHandle);
 
 	// Bug: opening tab 1 (3D graph), while the program executes, may stop data acquisition
@@ -128,21 +211,22 @@ int CVICALLBACK ConfigCallBack (int panel, int control, int event,
 			if(!comport || RS232Error)
 				return 0;  // Configuration wasn't performed
 
+			// Create the lock-free rings and snapshot that carry decoded data to the UI thread
+			if (SpscRingInit (&vectorRing, VECTOR_RING_SIZE, DATA_SIZE) < 0
+				|| SpscRingInit (&magnitudeRing, VECTOR_RING_SIZE, sizeof(double)) < 0
+				|| SnapshotInit (&stateSnapshot, sizeof(AcquisitionState)) < 0)
+			{
+				SpscRingFree (&vectorRing);
+				SpscRingFree (&magnitudeRing);
+				MessagePopup ("Error", "Out of memory for the receive ring.\n");
+				return 0;
+			}
+
 			// Disable the Configure button
 			SetCtrlAttribute (panelHandle, PANEL_COM_CONFIG, ATTR_DIMMED, 1);
 
 			// Start the thread function to read data
 			CmtScheduleThreadPoolFunction (DEFAULT_THREAD_POOL_HANDLE, ReadDataThreadFunction, 0, &threadFunctionId);
-
-			// Create a new lock for synchronization
-			CmtNewLock (NULL, OPT_TL_PROCESS_EVENTS_WHILE_WAITING, &lock);
-
-			// Creates a thread safe queue for use in the program
-			CmtNewTSQ(MAX_ITEMS_IN_QUEUE, sizeof(char), 0, &tsqHandle);
-
-			// Install the callback to read and process the data from the thread-safe queue.
-			CmtInstallTSQCallback(tsqHandle, EVENT_TSQ_ITEMS_IN_QUEUE, MAX_ITEMS_IN_QUEUE_READ_BLOCK,
-								  ProcessDataFromQueueCallback, NULL, CmtGetCurrentThreadID(), NULL);
 			break;
 	}
 	return 0;
@@ -163,14 +247,18 @@ int CVICALLBACK Start (int panel, int control, int event,
 			SetCtrlAttribute(panelHandle, PANEL_START, ATTR_DIMMED, 1);
 			// Disable the write toggle button
 			SetCtrlAttribute(panelHandle, PANEL_WRITE_TO_FILE, ATTR_DIMMED, 1);
-			// Disable the select file button
+			// Disable the select file and open log buttons
 			SetCtrlAttribute(tabHandle_LiveChart, TABPANEL_SELECT_FILE, ATTR_DIMMED, 1);
+			SetCtrlAttribute(tabHandle_LiveChart, openLogButton, ATTR_DIMMED, 1);
 			// Disable path text editing
 			SetCtrlAttribute(tabHandle_LiveChart, TABPANEL_PATH, ATTR_NO_EDIT_TEXT , 1);
 			// Disable the window and sample rate control
 			SetCtrlAttribute(panelHandle, PANEL_WINDOW, ATTR_DIMMED, 1);
 			SetCtrlAttribute(panelHandle, PANEL_SR, ATTR_DIMMED, 1);
 
+			// A log opened for replay gives way to the new acquisition
+			CloseReplay();
+
 			// Get the sampling rate of the signal
 			GetCtrlVal(panelHandle, PANEL_SR, &fs);
 			
@@ -183,6 +271,23 @@ int CVICALLBACK Start (int panel, int control, int event,
 			// Create file to write if needed
 			WriteToFile();
 
+			// Show the live spectrogram in place of the spectrum
+			SetCtrlAttribute (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, ATTR_VISIBLE, 0);
+			SetCtrlAttribute (tabHandle_FFT, spectrogramGraph, ATTR_VISIBLE, 1);
+			SpectrogramStart (&spectrogram, fs);
+			TrajectoryReset (&trajectory, fs, TRAJECTORY_SECONDS, TRAJECTORY_POINTS);
+
+			// Drop what is left of the last capture and start decoding from scratch
+			ResetReceive();
+			chartRate = fs;
+			SetCtrlVal (panelHandle, droppedIndicator, 0);
+			SetCtrlVal (panelHandle, missingIndicator, 0);
+			SetCtrlVal (panelHandle, interpolatedIndicator, 0);
+			SetCtrlVal (panelHandle, rateIndicator, 0.0);
+
+			// Display the received data at a steady rate, independent of the data rate
+			SetCtrlAttribute (panelHandle, refreshTimer, ATTR_ENABLED, 1);
+
 			// Set DTR ON to establish connection
 			ComSetEscape (comport, SETDTR);
 			
@@ -202,179 +307,353 @@ static int CVICALLBACK ReadDataThreadFunction (void *functionData)
 		ToggleConnectLED(); // Transmitter's com connection present
 	
 	// Minimum number of bytes the input queue must contain before sending the LWRS_RECEIVE.
-	int notify_count = 25;
+	int notify_count = FRAME_MIN_SIZE;
 	
 	InstallComCallback (comport, LWRS_DSR | LWRS_RECEIVE, notify_count, 0, ComCallback, 0);
 	return 0;
 }
 
 //-----------------------------------------------------------------------------
-// Com callback that runs inside it's own thread
+// Com callback that runs inside it's own thread. It only decodes, the UI
+// thread displays the results at REFRESH_INTERVAL.
 //-----------------------------------------------------------------------------
 void CVICALLBACK ComCallback (int portNumber, int eventMask, void *callbackData)
 {
-	char packet[PACKET_SIZE];
-	double xyz_vector[NUM_ELEMENTS];
-	double magnitude;
-	static double min = 0.0;
-	static double max = 0.0;
-	static int n = 0;
-	char checksum;
-	int i;
+	AcquisitionState *state;
+	double *vectors;
+	double *magnitudes;
+	unsigned char *space;
+	unsigned int numFree;
+	unsigned int numMagnitudes;
+	int numBytes;
+	int numValid;
 
 	if (eventMask & LWRS_DSR)
 		ToggleConnectLED(); // Transmitter's com connected
 
-	if (eventMask & LWRS_RECEIVE)
+	// Leave the receive path alone while Start resets it, the bytes are dropped anyway
+	if ((eventMask & LWRS_RECEIVE)
+		&& AtomicCompareExchange (&receiveGate, RECEIVE_IDLE, RECEIVE_BUSY) == RECEIVE_IDLE)
 	{
-		CmtGetLock (lock);
-
-		// Receive the packet over the communication channel
-		ComRd(comport, packet, PACKET_SIZE);
+		do
+		{
+			// Drain everything waiting in the input queue into the frame decoder
+			space = FrameDecoderSpace (&acquisition.decoder, &numBytes);
+			if (numBytes > GetInQLen(comport))
+				numBytes = GetInQLen(comport);
+			if (numBytes > 0)
+				FrameDecoderCommit (&acquisition.decoder, ComRd(comport, (char *)space, numBytes));
+
+			// Decode the received frames straight into the rings, calculate magnitudes, min and max.
+			// Both rings have the same size and advance together, so their free runs match.
+			numFree = MAX_VECTORS_PER_READ;
+			vectors = SpscRingReserve (&vectorRing, &numFree);
+			numMagnitudes = numFree;
+			magnitudes = SpscRingReserve (&magnitudeRing, &numMagnitudes);
+			if (numFree > numMagnitudes)
+				numFree = numMagnitudes;
+			if (numFree == 0)
+				break; // The UI thread is behind, the bytes wait in the decoder and the input queue
+			numValid = AcquisitionDecode (&acquisition, vectors, magnitudes, numFree);
+
+			if (numValid)
+			{
+				memcpy(latest, vectors + (numValid - 1) * NUM_ELEMENTS, DATA_SIZE);
+				latestMagnitude = magnitudes[numValid - 1];
 
-		// Calculate checksum
-		for (i = 0, checksum = 0; i < DATA_SIZE; i++)
-			checksum ^= packet[i]; // XOR operation
+				// Magnitudes first, so the UI thread finds them with the vectors
+				SpscRingPublish (&magnitudeRing, numValid);
+				SpscRingPublish (&vectorRing, numValid);
+			}
+		}
+		while (numValid == (int)numFree || GetInQLen(comport) > 0);
+
+		// Publish the latest state for the display refresh
+		state = SnapshotBack (&stateSnapshot);
+		memcpy(state->vector, latest, DATA_SIZE);
+		state->magnitude = latestMagnitude;
+		state->min = acquisition.stats.min;
+		state->max = acquisition.stats.max;
+		state->count = (unsigned int)acquisition.stats.count;
+		state->framesDropped = acquisition.decoder.framesDropped;
+		state->missing = (unsigned int)acquisition.missing;
+		state->interpolated = (unsigned int)acquisition.interpolated;
+		state->rate = AcquisitionRate (&acquisition);
+		SnapshotPublish (&stateSnapshot);
+
+		AtomicStore (&receiveGate, RECEIVE_IDLE);
+	}
+}
 
-		if (checksum == packet[DATA_SIZE])
-		{
-			// Checksum is valid
+//-----------------------------------------------------------------------------
+// Start the receive path over for a new capture. The com callback is stopped
+// first, so nothing of the last capture left in the input queue, the decoder
+// or the rings reaches the new one.
+//-----------------------------------------------------------------------------
+static void ResetReceive (void)
+{
+	// Wait for a callback that is decoding, later ones return right away
+	while (AtomicCompareExchange (&receiveGate, RECEIVE_IDLE, RECEIVE_PAUSED) != RECEIVE_IDLE)
+		Delay (RECEIVE_WAIT);
+
+	// The UI thread is the only side of the rings left running
+	FlushInQ (comport);
+	DrainRing (&vectorRing);
+	DrainRing (&magnitudeRing);
+
+	// Start hunting for the first frame and sequence number from scratch
+	AcquisitionInit (&acquisition);
+	SnapshotClear (&stateSnapshot);
+	memset(latest, 0, sizeof(latest));
+	latestMagnitude = 0.0;
+
+	AtomicStore (&receiveGate, RECEIVE_IDLE);
+}
 
-			// Extract x, y, z from the data in the packet
-			memcpy(xyz_vector, packet, DATA_SIZE);
+//-----------------------------------------------------------------------------
+// Consume everything queued in a ring
+//-----------------------------------------------------------------------------
+static void DrainRing (SpscRing *ring)
+{
+	unsigned int count;
 
-			// Display the data in numeric controls.
-			SetCtrlVal(tabHandle_LiveChart, TABPANEL_X, xyz_vector[0]);
-			SetCtrlVal(tabHandle_LiveChart, TABPANEL_Y, xyz_vector[1]);
-			SetCtrlVal(tabHandle_LiveChart, TABPANEL_Z, xyz_vector[2]);
+	do
+	{
+		count = VECTOR_RING_SIZE;
+		SpscRingPeek (ring, &count);
+		SpscRingConsume (ring, count);
+	}
+	while (count > 0);
+}
 
-			// Calculate magnitude
-			MatrixNorm (xyz_vector, 1, NUM_ELEMENTS, NORM_TYPE_2, &magnitude);
+//-----------------------------------------------------------------------------
+// Display refresh on the UI thread while acquiring
+//-----------------------------------------------------------------------------
+static int CVICALLBACK RefreshTimerCallback (int panel, int control, int event,
+											 void *callbackData, int eventData1, int eventData2)
+{
+	switch (event)
+	{
+		case EVENT_TIMER_TICK:
+			ProcessVectors();
+			RefreshIndicators();
+			break;
+	}
+	return 0;
+}
 
-			// Update the strip chart and magnitude value
-			PlotStripChartPoint(tabHandle_LiveChart, TABPANEL_STRIPCHART, magnitude);
-			SetCtrlVal (tabHandle_LiveChart, TABPANEL_MAG, magnitude);
+//-----------------------------------------------------------------------------
+// Consume every vector in the ring in place: store, log and forward them to
+// the spectrogram, and plot their magnitudes, in as few runs as the ring's
+// wrap allows
+//-----------------------------------------------------------------------------
+void ProcessVectors()
+{
+	const double *vectors;
+	const double *magnitudes;
+	unsigned int numVectors;
+	size_t numStored = store.count;
 
-			// Calculate and display min and max magnitudes
-			if (magnitude < min || min == 0.0)
-				min = magnitude;
-			if (magnitude > max || max == 0.0)
-				max = magnitude;
-			SetCtrlVal (tabHandle_LiveChart, TABPANEL_MINB, min);
-			SetCtrlVal (tabHandle_LiveChart, TABPANEL_MAXB, max);
+	for (;;)
+	{
+		numVectors = VECTOR_RING_SIZE;
+		vectors = SpscRingPeek (&vectorRing, &numVectors);
+		magnitudes = SpscRingPeek (&magnitudeRing, &numVectors);
+		if (numVectors == 0)
+			break;
 
-			// Write x, y, z values to a file
-			if (writeToFile)
+		// Append the vectors to the sample store
+		if (SampleStoreAppend (&store, vectors, numVectors) < 0)
+		{
+			// Drop what is queued, Stop consumes the rings again
+			do
 			{
-				int bufferLen;
-				double timef = startTime + n * deltaTime;
+				SpscRingConsume (&vectorRing, numVectors);
+				SpscRingConsume (&magnitudeRing, numVectors);
+				numVectors = VECTOR_RING_SIZE;
+				SpscRingPeek (&vectorRing, &numVectors);
+			}
+			while (numVectors);
+			Stop(panelHandle, 1, 1, NULL, 1, 1);
+			MessagePopup ("Error", "Out of memory for received data.\n");
+			return;
+		}
 
-				// Format a given time into a string buffer according to the TIME_FORMAT_STRING.
-				bufferLen = FormatDateTimeString (timef, TIME_FORMAT_STRING, NULL, 0);
-				dateTimeBuffer = malloc (bufferLen + 1);
-				FormatDateTimeString (timef, TIME_FORMAT_STRING, dateTimeBuffer, bufferLen + 1 );
+		// Strip chart update for the whole run, decimated to the plot width
+		PlotMagnitudes (magnitudes, numVectors);
 
-				// Write data to the file
-				fprintf(filehandle, "%s \t %.2f \t %.2f \t %.2f\n", dateTimeBuffer,
-						xyz_vector[0], xyz_vector[1], xyz_vector[2]);
+		// Forward the vectors to the live spectrogram and the 3D trajectory
+		SpectrogramFeed (&spectrogram, vectors, numVectors);
+		TrajectoryAppend (&trajectory, vectors, numVectors);
 
-			}
+		// Hand the vectors to the logger thread, never waits for the disk
+		if (writeToFile)
+			DataLoggerWrite (&logger, vectors, numVectors);
 
-			// Update and display the number of vectors received
-			SetCtrlVal(panelHandle, PANEL_NUMERIC, n);
-			n++;
+		SpscRingConsume (&vectorRing, numVectors);
+		SpscRingConsume (&magnitudeRing, numVectors);
+	}
 
-			// Write the packet to the thread-safe queue for further processing
-			CmtWriteTSQData(tsqHandle, packet, DATA_SIZE, TSQ_INFINITE_TIMEOUT, NULL);
-		}
-		else
+	// Visualize the latest data
+	if (store.count != numStored && store.count >= NUM_VECTORS)
+		VisualizeData(store.count, 0);
+}
+
+//-----------------------------------------------------------------------------
+// Show the latest state the serial thread published
+//-----------------------------------------------------------------------------
+void RefreshIndicators()
+{
+	const AcquisitionState *state = SnapshotLatest (&stateSnapshot);
+	double pending[2];
+	int numPending;
+
+	if (state->count == 0)
+		return; // Nothing received yet
+
+	// Display the latest vector and its magnitude in numeric controls
+	SetCtrlVal (tabHandle_LiveChart, TABPANEL_X, state->vector[0]);
+	SetCtrlVal (tabHandle_LiveChart, TABPANEL_Y, state->vector[1]);
+	SetCtrlVal (tabHandle_LiveChart, TABPANEL_Z, state->vector[2]);
+	SetCtrlVal (tabHandle_LiveChart, TABPANEL_MAG, state->magnitude);
+
+	// Display min and max magnitudes and the number of vectors received
+	SetCtrlVal (tabHandle_LiveChart, TABPANEL_MINB, state->min);
+	SetCtrlVal (tabHandle_LiveChart, TABPANEL_MAXB, state->max);
+	SetCtrlVal (panelHandle, PANEL_NUMERIC, (int)state->count - 1);
+
+	// Corrupted and lost frames are counted, acquisition goes on
+	SetCtrlVal (panelHandle, droppedIndicator, state->framesDropped);
+	SetCtrlVal (panelHandle, missingIndicator, state->missing);
+	SetCtrlVal (panelHandle, interpolatedIndicator, state->interpolated);
+
+	// Put the strip chart on the sender's clock once its rate is measured
+	if (state->rate > 0)
+	{
+		SetCtrlVal (panelHandle, rateIndicator, state->rate);
+		if (fabs (state->rate - chartRate) > RATE_TOLERANCE * chartRate)
 		{
-			// Checksum is invalid
-			Stop(panelHandle, 1, 1, NULL, 1, 1);
-			MessagePopup ("Error", "Invalid Checksum. Data lost.\n");
-		}
+			// Keep the samples of a partly filled column
+			numPending = (int)EnvelopeFlush (&chartEnvelope, pending);
+			if (numPending)
+				PlotStripChart (tabHandle_LiveChart, TABPANEL_STRIPCHART, pending, numPending, 0, 0, VAL_DOUBLE);
 
-		CmtReleaseLock (lock);
+			chartRate = state->rate;
+			StripChartScale (chartRate);
+		}
 	}
 }
 
 //-----------------------------------------------------------------------------
-// Read and Process data from the thread safe queue Callback function
+// Follow the vectors up to last in the table and redraw the 3D trajectory,
+// at most every TRAJECTORY_INTERVAL unless forced
 //-----------------------------------------------------------------------------
-static void CVICALLBACK ProcessDataFromQueueCallback(CmtTSQHandle queueHandle, unsigned int event,
-		int value, void *callbackData)
+void VisualizeData(size_t last, int force)
 {
-	int i;
-	int numItemsRead;
-	char readBuffer[MAX_ITEMS_IN_QUEUE];
-	int size;
-	int readBuffer_shift;
+	static double lastFrame;
+	static unsigned long framePoints;
+	static double x[TRAJECTORY_MAX_POINTS], y[TRAJECTORY_MAX_POINTS], z[TRAJECTORY_MAX_POINTS];
+	size_t numPoints;
+	int follow;
+	VARIANT xVar, yVar, zVar;
 
-	// Use a buffer to read the data from the thread-safe queue.
-	numItemsRead = CmtReadTSQData(tsqHandle, readBuffer, MAX_ITEMS_IN_QUEUE_READ_BLOCK, 0, 0);
+	if (!force && Timer () - lastFrame < TRAJECTORY_INTERVAL)
+		return;
+	lastFrame = Timer ();
 
-	if (numItemsRead == MAX_ITEMS_IN_QUEUE_READ_BLOCK)
+	// The table scrolls over the whole store, it shows the latest vectors unless the operator scrolled away
+	SetCtrlAttribute (tabHandle_3DGraph, tableScroll, ATTR_MAX_VALUE, (unsigned int)(store.count - NUM_VECTORS));
+	GetCtrlVal (tabHandle_3DGraph, followLatest, &follow);
+	if (follow)
 	{
-		// Resize the arrays to accommodate the new data
-		size = (NUM_VECTORS + shift) * sizeof(double);
-		x = (double*)realloc(x, size);
-		y = (double*)realloc(y, size);
-		z = (double*)realloc(z, size);
+		SetCtrlVal (tabHandle_3DGraph, tableScroll, (unsigned int)(last - NUM_VECTORS));
+		ShowTableRows (last - NUM_VECTORS);
+	}
 
-		for(i = 0; i < NUM_VECTORS; i++)
-		{
-			// Extract x, y, z values separately from the data in readBuffer
-			readBuffer_shift = i * DATA_SIZE;
-			memcpy(x + i + shift, readBuffer + readBuffer_shift, sizeof(double));
-			memcpy(y + i + shift, readBuffer + readBuffer_shift + sizeof(double), sizeof(double));
-			memcpy(z + i + shift, readBuffer + readBuffer_shift + 2 * sizeof(double), sizeof(double));
-		}
+	// The curve only changes when a point was completed since the last frame
+	if (trajectory.total == framePoints || trajectory.count < 2)
+		return;
+	framePoints = trajectory.total;
 
-		// Visualize the data
-		VisualizeData();
+	// Unroll the trajectory ring, oldest point first
+	numPoints = TrajectoryCopyAxis (&trajectory, 0, x);
+	TrajectoryCopyAxis (&trajectory, 1, y);
+	TrajectoryCopyAxis (&trajectory, 2, z);
 
-		shift += NUM_VECTORS;
-	}
-	else
-	{
-		Stop(panelHandle, 1, 1, NULL, 1, 1);
-		MessagePopup ("Error", "Failed to read from thread-safe queue.\n");
-	}
+	// Create variants from the 1D arrays
+	CA_VariantSetEmpty(&xVar);
+	CA_VariantSetEmpty(&yVar);
+	CA_VariantSetEmpty(&zVar);
+	CA_VariantSet1DArray(&xVar, CAVT_DOUBLE, numPoints, x);
+	CA_VariantSet1DArray(&yVar, CAVT_DOUBLE, numPoints, y);
+	CA_VariantSet1DArray(&zVar, CAVT_DOUBLE, numPoints, z);
+
+	// Plot the path of the field vector as a 3D curve
+	CW3DGraphLib__DCWGraph3DPlot3DCurve(graphHandle, NULL, xVar, yVar, zVar, CA_DEFAULT_VAL);
+
+	// Clear the variants to release memory
+	CA_VariantClear(&xVar);
+	CA_VariantClear(&yVar);
+	CA_VariantClear(&zVar);
 }
 
 //-----------------------------------------------------------------------------
-// Visualize the data by plotting it as a 3D surface
+// Fetch the NUM_VECTORS vectors from first on out of the store into the table,
+// which never holds more rows than it shows
 //-----------------------------------------------------------------------------
-void VisualizeData()
+void ShowTableRows(size_t first)
 {
 	static int tableRowsInserted = 0;
-	VARIANT xVar, yVar, zVar;
-	CA_VariantSetEmpty(&xVar);
-	CA_VariantSetEmpty(&yVar);
-	CA_VariantSetEmpty(&zVar);
+	double x[NUM_VECTORS], y[NUM_VECTORS], z[NUM_VECTORS];
+	char label[32];
+	int row;
 
 	if (!tableRowsInserted)
 	{
 		InsertTableRows (tabHandle_3DGraph, TABPANEL_2_TABLE,-1, NUM_VECTORS, VAL_CELL_NUMERIC);
+		for (row = 1; row <= NUM_VECTORS; row++)
+			SetTableRowAttribute (tabHandle_3DGraph, TABPANEL_2_TABLE, row, ATTR_USE_LABEL_TEXT, 1);
 		tableRowsInserted = 1;
 	}
-	// Display vector values
-	SetTableCellRangeVals (tabHandle_3DGraph, TABPANEL_2_TABLE, MakeRect (1, 1, NUM_VECTORS, 1), x + shift, VAL_ROW_MAJOR);
-	SetTableCellRangeVals (tabHandle_3DGraph, TABPANEL_2_TABLE, MakeRect (1, 2, NUM_VECTORS, 1), y + shift, VAL_ROW_MAJOR);
-	SetTableCellRangeVals (tabHandle_3DGraph, TABPANEL_2_TABLE, MakeRect (1, 3, NUM_VECTORS, 1), z + shift, VAL_ROW_MAJOR);
-
-	// Create variants from the 1D arrays
-	CA_VariantSet1DArray(&xVar, CAVT_DOUBLE, NUM_VECTORS, x + shift);
-	CA_VariantSet1DArray(&yVar, CAVT_DOUBLE, NUM_VECTORS, y + shift);
-	CA_VariantSet1DArray(&zVar, CAVT_DOUBLE, NUM_VECTORS, z + shift);
+	// Gather the vectors axis by axis
+	SampleStoreCopyAxis (&store, 0, first, NUM_VECTORS, x);
+	SampleStoreCopyAxis (&store, 1, first, NUM_VECTORS, y);
+	SampleStoreCopyAxis (&store, 2, first, NUM_VECTORS, z);
+
+	// Display vector values, labelled with their index in the store
+	SetTableCellRangeVals (tabHandle_3DGraph, TABPANEL_2_TABLE, MakeRect (1, 1, NUM_VECTORS, 1), x, VAL_ROW_MAJOR);
+	SetTableCellRangeVals (tabHandle_3DGraph, TABPANEL_2_TABLE, MakeRect (1, 2, NUM_VECTORS, 1), y, VAL_ROW_MAJOR);
+	SetTableCellRangeVals (tabHandle_3DGraph, TABPANEL_2_TABLE, MakeRect (1, 3, NUM_VECTORS, 1), z, VAL_ROW_MAJOR);
+	for (row = 1; row <= NUM_VECTORS; row++)
+	{
+		sprintf (label, "%lu", (unsigned long)(first + row - 1));
+		SetTableRowAttribute (tabHandle_3DGraph, TABPANEL_2_TABLE, row, ATTR_LABEL_TEXT, label);
+	}
+}
 
-	// Plot x, y, and z as a 3D surface
-	CW3DGraphLib__DCWGraph3DPlot3DMesh(graphHandle, NULL, xVar, yVar, zVar, CA_DEFAULT_VAL);
+//-----------------------------------------------------------------------------
+// Show the vectors the operator scrolled to, fetched on demand
+//-----------------------------------------------------------------------------
+static int CVICALLBACK TableScrollCallback (int panel, int control, int event,
+											void *callbackData, int eventData1, int eventData2)
+{
+	unsigned int first;
 
-	// Clear the variants to release memory
-	CA_VariantClear(&xVar);
-	CA_VariantClear(&yVar);
-	CA_VariantClear(&zVar);
+	switch (event)
+	{
+		case EVENT_VAL_CHANGED:
+			if (store.count < NUM_VECTORS)
+				break;
+			GetCtrlVal (panel, tableScroll, &first);
+			if (first > store.count - NUM_VECTORS)
+				first = (unsigned int)(store.count - NUM_VECTORS);
+
+			// Looking back stops following, scrolling to the end follows again
+			SetCtrlVal (panel, followLatest, first == store.count - NUM_VECTORS);
+			ShowTableRows (first);
+			break;
+	}
+	return 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -382,8 +661,6 @@ void VisualizeData()
 //-----------------------------------------------------------------------------
 void StripChartTimeAxis()
 {
-	int window;
-
 	// Get the current system time
 	GetCurrentDateTime(&startTime);
 	// Set the charts start time according to the system time
@@ -391,12 +668,61 @@ void StripChartTimeAxis()
 
 	// Calculate the time elapsed between consecutive measures
 	deltaTime = 1.0 / fs;
-	// Set the charts increment according to the sampling rate
-	SetCtrlAttribute(tabHandle_LiveChart, TABPANEL_STRIPCHART, ATTR_XAXIS_GAIN, deltaTime);
 
-	// Set the time window display of the strip chart
+	// Set the charts increment and time window according to the sampling rate
+	StripChartScale(fs);
+}
+
+//-----------------------------------------------------------------------------
+// Fit the strip chart's window to its plot width: above two samples per pixel
+// column each column shows the min/max envelope of its samples, so the points
+// plotted per screen stay bounded by the width at any rate and window
+//-----------------------------------------------------------------------------
+void StripChartScale(double rate)
+{
+	double samplesPerScreen;
+	size_t bucketSize;
+	int window;
+	int width;
+
 	GetCtrlVal(panelHandle, PANEL_WINDOW, &window);
-	SetCtrlAttribute (tabHandle_LiveChart, TABPANEL_STRIPCHART, ATTR_POINTS_PER_SCREEN, (int)(window * fs));
+	GetCtrlAttribute(tabHandle_LiveChart, TABPANEL_STRIPCHART, ATTR_PLOT_AREA_WIDTH, &width);
+	samplesPerScreen = window * rate;
+	bucketSize = EnvelopeBucketSize(samplesPerScreen, width);
+	EnvelopeInit(&chartEnvelope, bucketSize);
+
+	if (bucketSize == 1)
+	{
+		SetCtrlAttribute(tabHandle_LiveChart, TABPANEL_STRIPCHART, ATTR_XAXIS_GAIN, 1.0 / rate);
+		SetCtrlAttribute(tabHandle_LiveChart, TABPANEL_STRIPCHART, ATTR_POINTS_PER_SCREEN, (int)samplesPerScreen);
+	}
+	else
+	{
+		// Each point of a min/max pair stands for half a bucket
+		SetCtrlAttribute(tabHandle_LiveChart, TABPANEL_STRIPCHART, ATTR_XAXIS_GAIN, bucketSize / (2.0 * rate));
+		SetCtrlAttribute(tabHandle_LiveChart, TABPANEL_STRIPCHART, ATTR_POINTS_PER_SCREEN,
+						 2 * (int)ceil(samplesPerScreen / bucketSize));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Append magnitudes to the strip chart through the envelope decimator
+//-----------------------------------------------------------------------------
+void PlotMagnitudes(const double *magnitudes, size_t numMagnitudes)
+{
+	static double points[ENVELOPE_MAX_POINTS(CHART_CHUNK)];
+	size_t numSamples;
+	size_t numPoints;
+
+	while (numMagnitudes)
+	{
+		numSamples = numMagnitudes < CHART_CHUNK ? numMagnitudes : CHART_CHUNK;
+		numPoints = EnvelopeFeed(&chartEnvelope, magnitudes, numSamples, points);
+		if (numPoints)
+			PlotStripChart(tabHandle_LiveChart, TABPANEL_STRIPCHART, points, numPoints, 0, 0, VAL_DOUBLE);
+		magnitudes += numSamples;
+		numMagnitudes -= numSamples;
+	}
 }
 
 
@@ -406,15 +732,36 @@ void StripChartTimeAxis()
 int CVICALLBACK Stop (int panel, int control, int event,
 					  void *callbackData, int eventData1, int eventData2)
 {
+	const AcquisitionState *state;
+
 	switch (event)
 	{
 		case EVENT_COMMIT:
 			// Set DTR OFF to stop the transmission
 			ComSetEscape (comport, CLRDTR);
+			// Store, log, analyse and display every vector received so far
+			SetCtrlAttribute (panelHandle, refreshTimer, ATTR_ENABLED, 0);
+			ProcessVectors();
+			RefreshIndicators();
+			if (store.count >= NUM_VECTORS)
+				VisualizeData (store.count, 1);
+			// Finish the live spectrogram, it stays on screen until PLOT FFT
+			SpectrogramStop (&spectrogram);
+			// The spectrum and the log use the rate measured from the sender's timestamps,
+			// the configured one is kept when the capture was too short to measure it
+			state = SnapshotLatest (&stateSnapshot);
+			if (state->rate > 0)
+			{
+				fs = state->rate;
+				logger.fs = fs;
+			}
+			// Logging happens on this thread, so the log can be closed right away
+			CloseLogFile();
 			// Disable the stop button
 			SetCtrlAttribute(panelHandle, PANEL_STOP, ATTR_DIMMED, 1);
-			// Enable the PLOT FFT button
+			// Enable the PLOT FFT and open log buttons
 			SetCtrlAttribute(tabHandle_FFT, TABPANEL_3_PLOT_FFT, ATTR_DIMMED, 0);
+			SetCtrlAttribute(tabHandle_LiveChart, openLogButton, ATTR_DIMMED, 0);
 			break;
 	}
 	return 0;
@@ -437,11 +784,7 @@ int CVICALLBACK QuitCallback (int panel, int control, int event,
 				// Release thread function
 				CmtReleaseThreadPoolFunctionID (DEFAULT_THREAD_POOL_HANDLE, threadFunctionId);
 			}
-			if (tsqHandle)
-			{
-				// Discare thread safe queue task
-				CmtDiscardTSQ(tsqHandle);
-			}
+			SpectrogramDiscard (&spectrogram);
 			if (port_open)
 			{
 				FlushInQ (comport);
@@ -450,19 +793,15 @@ int CVICALLBACK QuitCallback (int panel, int control, int event,
 				RS232Error = CloseCom (comport);
 				if (RS232Error) DisplayRS232Error ();
 			}
-			if (filehandle)
-				fclose (filehandle);
-			CmtDiscardLock (lock);
+			CloseLogFile();
+			SpscRingFree (&vectorRing);
+			SpscRingFree (&magnitudeRing);
+			SnapshotFree (&stateSnapshot);
 			CA_DiscardObjHandle (plotHandle);
 			CA_DiscardObjHandle (plotsHandle);
-			free(x);
-			x = NULL;
-			free(y);
-			y = NULL;
-			free(z);
-			z = NULL;
-			free(dateTimeBuffer);
-			dateTimeBuffer = NULL;
+			CloseReplay();
+			SampleStoreFree (&store);
+			FftEngineFree (&fftEngine);
 			QuitUserInterface (0);
 			break;
 	}
@@ -478,62 +817,43 @@ int CVICALLBACK PlotFFT (int panel, int control, int event,
 	switch (event)
 	{
 		case EVENT_COMMIT:
-			if(!shift) 
+			if(!store.count)
 				return 0; // Not enough vectors for fft
 
-			int i;
-			int num_vectors = shift;
-			double xfft_real[num_vectors], yfft_real[num_vectors], zfft_real[num_vectors];
-			double xfft_imag[num_vectors], yfft_imag[num_vectors], zfft_imag[num_vectors];
-			double 	freqArray[num_vectors];
-			double 	xmagArray[num_vectors];
-			double 	ymagArray[num_vectors];
-			double 	zmagArray[num_vectors];
-			double 	phaseArray[num_vectors];
-			double 	matrix[NUM_ELEMENTS][num_vectors];
-			double 	mag_matrix[num_vectors][NUM_ELEMENTS];
-			double  magnitudeArray[num_vectors];
-			double  df;
-
-			// Apply window to the segment to reduce spectral leakage
-			HamWin (x, num_vectors);
-			HamWin (y, num_vectors);
-			HamWin (z, num_vectors);
-
-			// Calculate the FFT
-			Copy1D (x, num_vectors, xfft_real);
-			Copy1D (y, num_vectors, yfft_real);
-			Copy1D (z, num_vectors, zfft_real);
-			ReFFT (xfft_real, xfft_imag, num_vectors);
-			ReFFT (yfft_real, yfft_imag, num_vectors);
-			ReFFT (zfft_real, zfft_imag, num_vectors);
-			ToPolar1D (xfft_real, xfft_imag, num_vectors, xmagArray, phaseArray);
-			ToPolar1D (yfft_real, yfft_imag, num_vectors, ymagArray, phaseArray);
-			ToPolar1D (zfft_real, zfft_imag, num_vectors, zmagArray, phaseArray);
-
-			// Create a 2D array from 1D arrays x, y, and z
-			memcpy(matrix[0], xmagArray, num_vectors * sizeof(double));
-			memcpy(matrix[1], ymagArray, num_vectors * sizeof(double));
-			memcpy(matrix[2], zmagArray, num_vectors * sizeof(double));
-			Transpose (matrix, NUM_ELEMENTS, num_vectors, mag_matrix);
-
-			MatrixNorm (mag_matrix[0], 1, NUM_ELEMENTS, NORM_TYPE_2, magnitudeArray);
-			magnitudeArray[0] /= num_vectors; // Normalize DC
-			df = fs/num_vectors; // Calculate frequency resolution 
-			for(i = 0; i <= num_vectors/2; i++)
+			int num_bins;
+			int window;
+			int spectrum;
+			// Calculate the spectrum in the engine's reusable workspace
+			GetCtrlVal (tabHandle_FFT, windowRing, &window);
+			GetCtrlVal (tabHandle_FFT, spectrumRing, &spectrum);
+			num_bins = 0;
+			if (spectrum == SPECTRUM_WELCH_PSD)
+			{
+				num_bins = FftEngineWelch (&fftEngine, &store, fs, window);
+				SetCtrlAttribute (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, ATTR_YNAME, "Density (nT/sqrt(Hz))");
+			}
+			// A record shorter than WELCH_MIN_SEGMENT falls back to the amplitude spectrum
+			if (num_bins == 0)
+			{
+				num_bins = FftEngineCompute (&fftEngine, &store, fs, window);
+				SetCtrlAttribute (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, ATTR_YNAME, "Amplitude (nT)");
+			}
+			if (num_bins < 0)
 			{
-				// Calculate magnitudes  
-				MatrixNorm (mag_matrix[i + 1], 1, NUM_ELEMENTS, NORM_TYPE_2, magnitudeArray + i + 1); 
-				// Normalize magnitudes
-				magnitudeArray[i + 1] /= (num_vectors/2);
-				// Calculate frequencies 
-				freqArray[i] = i*df;
+				MessagePopup ("Error", "Out of memory for the Fourier transform.\n");
+				return 0;
 			}
+			// Fewer averages than WELCH_MIN_SEGMENTS make a noisy estimate, show how many
+			SetCtrlVal (tabHandle_FFT, segmentsIndicator, (unsigned int)fftEngine.numSegments);
+
 			// Plot the FFT magnitude
-			plotHandleFFT = PlotXY (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, freqArray, magnitudeArray, num_vectors/2 + 1, VAL_DOUBLE,
+			SetCtrlAttribute (tabHandle_FFT, spectrogramGraph, ATTR_VISIBLE, 0);
+			SetCtrlAttribute (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, ATTR_VISIBLE, 1);
+			if (plotHandleFFT > 0)
+				DeleteGraphPlot (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, plotHandleFFT, VAL_DELAYED_DRAW);
+			plotHandleFFT = PlotXY (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, fftEngine.frequency, fftEngine.magnitude, num_bins, VAL_DOUBLE,
 									VAL_DOUBLE, VAL_FAT_LINE, VAL_EMPTY_SQUARE, VAL_SOLID, 1, VAL_RED);
-			// Disable the PLOT FFT button
-			SetCtrlAttribute(tabHandle_FFT, TABPANEL_3_PLOT_FFT, ATTR_DIMMED, 1);
+			// The recorded data is untouched, so PLOT FFT stays enabled for another window
 			break;
 	}
 	return 0;
@@ -550,7 +870,7 @@ int CVICALLBACK SelectFileToWrite(int panel, int control, int event, void *callb
 	{
 		case EVENT_COMMIT:
 		{
-			if (FileSelectPopupEx ("", "*.txt", "TXT Files (*.txt)",
+			if (FileSelectPopupEx ("", "*" MAGNO_LOG_EXTENSION, "Log Files (*" MAGNO_LOG_EXTENSION ")",
 								   "Name of File to Save", VAL_SELECT_BUTTON, 0, 1, pathname) > 0)
 			{
 				SetCtrlVal (tabHandle_LiveChart, TABPANEL_PATH, pathname);
@@ -570,10 +890,311 @@ void WriteToFile()
 	if (!writeToFile)
 		return;
 
-	filehandle = fopen (pathname, "w+");
-	fprintf (filehandle, "MAGNETIC FIELD DATA \n\n");
-	fprintf(filehandle, "Time \t\t x \t\t y\t\t z \n");
-	fprintf (filehandle, "---------------------------------------------------------\n");
+	// Start the binary logger, the header records fs and the start time
+	if (DataLoggerOpen (&logger, pathname, fs, startTime) < 0)
+	{
+		writeToFile = 0;
+		MessagePopup ("Error", "Failed to create the log file.\n");
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Close the log file and report vectors that didn't make it to disk
+//-----------------------------------------------------------------------------
+void CloseLogFile()
+{
+	char message[256];
+
+	if (!logger.file)
+		return;
+
+	DataLoggerClose (&logger);
+
+	if (logger.writeError)
+		MessagePopup ("Error", "Failed to write to the log file.\n");
+	else if (logger.overruns)
+	{
+		sprintf (message, "%u vectors were not logged, the disk could not keep up.\n", logger.overruns);
+		MessagePopup ("Warning", message);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Choose a recorded log to replay and analyze
+//-----------------------------------------------------------------------------
+static int CVICALLBACK OpenLogCallback (int panel, int control, int event,
+										void *callbackData, int eventData1, int eventData2)
+{
+	char path[MAX_PATHNAME_LEN];
+
+	switch (event)
+	{
+		case EVENT_COMMIT:
+			if (FileSelectPopupEx ("", "*" MAGNO_LOG_EXTENSION ";*.txt", "Log Files (*" MAGNO_LOG_EXTENSION ");Text Logs (*.txt)",
+								   "Open Log", VAL_LOAD_BUTTON, 0, 1, path) > 0)
+			{
+				OpenLog (path);
+			}
+			break;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Map a recorded log and make it the sample store. The vectors stay in the
+// file, only the pages that are looked at are read. A text log is converted
+// once into a binary log next to it, later opens map the conversion directly.
+//-----------------------------------------------------------------------------
+void OpenLog(const char *path)
+{
+	char binaryPath[MAX_PATHNAME_LEN];
+	double lastDay;
+	int month, day, year;
+	int error;
+
+	CloseReplay();
+	SampleStoreFree (&store);
+
+	error = MagnoLogOpen (&logReader, path);
+	if (error == MAGNO_LOG_ERROR_FORMAT)
+	{
+		// Not a binary log, try the text format
+		if (strlen (path) + strlen (MAGNO_LOG_EXTENSION) >= MAX_PATHNAME_LEN)
+		{
+			MessagePopup ("Error", "The log path is too long.\n");
+			return;
+		}
+		sprintf (binaryPath, "%s" MAGNO_LOG_EXTENSION, path);
+
+		if (!FileExists (binaryPath, NULL))
+		{
+			SetWaitCursor (1);
+			GetCtrlVal (panelHandle, PANEL_SR, &fs); // Used when the rate can't be estimated
+
+			// The rows only carry the time of day, the log was last written on the day of its last row
+			if (GetFileDate (path, &month, &day, &year) < 0)
+				GetSystemDate (&month, &day, &year);
+			MakeDateTime (0, 0, 0.0, month, day, year, &lastDay);
+			error = MagnoLogConvertText (path, binaryPath, fs, lastDay);
+			SetWaitCursor (0);
+			if (error < 0)
+			{
+				MessagePopup ("Error", error == MAGNO_LOG_ERROR_FORMAT ? "The file is not a MagnoMonitor log.\n"
+							  : "Failed to convert the text log.\n");
+				return;
+			}
+		}
+		error = MagnoLogOpen (&logReader, binaryPath);
+	}
+	if (error < 0)
+	{
+		MessagePopup ("Error", error == MAGNO_LOG_ERROR_FORMAT ? "The file is not a MagnoMonitor log.\n"
+					  : "Failed to open the log file.\n");
+		return;
+	}
+
+	if (SampleStoreAttach (&store, logReader.vectors, logReader.numVectors) < 0)
+	{
+		MagnoLogClose (&logReader);
+		MessagePopup ("Error", "Out of memory for the log index.\n");
+		return;
+	}
+
+	// Use the recorded sampling rate and start time
+	fs = logReader.header.fs;
+	startTime = logReader.header.startTime;
+	deltaTime = 1.0 / fs;
+	SetCtrlVal (panelHandle, PANEL_SR, fs);
+
+	ClearStripChart (tabHandle_LiveChart, TABPANEL_STRIPCHART);
+	SetCtrlAttribute (tabHandle_LiveChart, TABPANEL_STRIPCHART, ATTR_XAXIS_OFFSET, startTime);
+	StripChartScale (fs);
+	TrajectoryReset (&trajectory, fs, TRAJECTORY_SECONDS, TRAJECTORY_POINTS);
+
+	// The whole log can be analyzed at once, the strip chart replays it
+	SetCtrlAttribute (tabHandle_FFT, TABPANEL_3_PLOT_FFT, ATTR_DIMMED, 0);
+	replayPosition = 0;
+	replayBacklog = 0.0;
+	SetCtrlAttribute (panelHandle, replayTimer, ATTR_ENABLED, 1);
+}
+
+//-----------------------------------------------------------------------------
+// Stop replaying and unmap the log, the sample store must not point into it
+//-----------------------------------------------------------------------------
+void CloseReplay()
+{
+	SetCtrlAttribute (panelHandle, replayTimer, ATTR_ENABLED, 0);
+	if (!logReader.file.size)
+		return;
+
+	SampleStoreFree (&store);
+	MagnoLogClose (&logReader);
+}
+
+//-----------------------------------------------------------------------------
+// Feed the strip chart and indicators from the mapped log at the replay speed
+//-----------------------------------------------------------------------------
+static int CVICALLBACK ReplayTimerCallback (int panel, int control, int event,
+											void *callbackData, int eventData1, int eventData2)
+{
+	static double magnitudes[REPLAY_MAX_VECTORS];
+	static MagnitudeStats stats;
+	const double *vectors;
+	double speed;
+	size_t numVectors;
+
+	switch (event)
+	{
+		case EVENT_TIMER_TICK:
+			if (replayPosition == 0)
+				MagnitudeStatsInit (&stats);
+
+			// Vectors due since the last tick, whole ones only
+			GetCtrlVal (tabHandle_LiveChart, replaySpeedControl, &speed);
+			replayBacklog += speed * fs * REPLAY_INTERVAL;
+			numVectors = (size_t)replayBacklog;
+			if (numVectors > store.count - replayPosition)
+				numVectors = store.count - replayPosition;
+			if (numVectors > REPLAY_MAX_VECTORS)
+				numVectors = REPLAY_MAX_VECTORS; // Keep the UI responsive at high speeds
+			replayBacklog -= numVectors;
+			if (replayBacklog > REPLAY_MAX_VECTORS)
+				replayBacklog = REPLAY_MAX_VECTORS;
+
+			if (numVectors == 0)
+			{
+				if (replayPosition == store.count)
+					SetCtrlAttribute (panelHandle, replayTimer, ATTR_ENABLED, 0); // Replay finished
+				break;
+			}
+
+			// Same processing as the live data, straight from the mapping
+			vectors = logReader.vectors + replayPosition * NUM_ELEMENTS;
+			MagnitudeCompute (&stats, vectors, (int)numVectors, magnitudes);
+			TrajectoryAppend (&trajectory, vectors, numVectors);
+			replayPosition += numVectors;
+			vectors += (numVectors - 1) * NUM_ELEMENTS;
+
+			SetCtrlVal (tabHandle_LiveChart, TABPANEL_X, vectors[0]);
+			SetCtrlVal (tabHandle_LiveChart, TABPANEL_Y, vectors[1]);
+			SetCtrlVal (tabHandle_LiveChart, TABPANEL_Z, vectors[2]);
+			PlotMagnitudes (magnitudes, numVectors);
+			SetCtrlVal (tabHandle_LiveChart, TABPANEL_MAG, magnitudes[numVectors - 1]);
+			SetCtrlVal (tabHandle_LiveChart, TABPANEL_MINB, stats.min);
+			SetCtrlVal (tabHandle_LiveChart, TABPANEL_MAXB, stats.max);
+			SetCtrlVal (panelHandle, PANEL_NUMERIC, (int)replayPosition - 1);
+
+			if (replayPosition >= NUM_VECTORS)
+				VisualizeData (replayPosition, replayPosition == store.count);
+			break;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Create the controls that are not part of the .uir, next to related ones
+//-----------------------------------------------------------------------------
+void CreateControls()
+{
+	int top, left, height, width;
+	int i;
+
+	// Number of corrupted frames, below the vector count
+	GetCtrlAttribute (panelHandle, PANEL_NUMERIC, ATTR_TOP, &top);
+	GetCtrlAttribute (panelHandle, PANEL_NUMERIC, ATTR_LEFT, &left);
+	GetCtrlAttribute (panelHandle, PANEL_NUMERIC, ATTR_HEIGHT, &height);
+
+	droppedIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Dropped frames", top + height + 25, left);
+	SetCtrlAttribute (panelHandle, droppedIndicator, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, droppedIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	// Vectors lost in sequence gaps, those of them interpolated and the sender's
+	// measured rate, below it
+	missingIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Missing vectors", top + 2 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, missingIndicator, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, missingIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	interpolatedIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Interpolated vectors", top + 3 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, interpolatedIndicator, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, interpolatedIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	rateIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Measured rate (Hz)", top + 4 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, rateIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	// FFT window selection, below the PLOT FFT button
+	GetCtrlAttribute (tabHandle_FFT, TABPANEL_3_PLOT_FFT, ATTR_TOP, &top);
+	GetCtrlAttribute (tabHandle_FFT, TABPANEL_3_PLOT_FFT, ATTR_LEFT, &left);
+	GetCtrlAttribute (tabHandle_FFT, TABPANEL_3_PLOT_FFT, ATTR_HEIGHT, &height);
+
+	windowRing = NewCtrl (tabHandle_FFT, CTRL_RING_LS, "Window", top + height + 25, left);
+	for (i = 0; i < WINDOW_NUM_TYPES; i++)
+		InsertListItem (tabHandle_FFT, windowRing, -1, WindowTypeName (i), i);
+	SetCtrlVal (tabHandle_FFT, windowRing, WINDOW_HAMMING);
+
+	// Spectrum type, below the window selection
+	spectrumRing = NewCtrl (tabHandle_FFT, CTRL_RING_LS, "Spectrum", top + 2 * (height + 25), left);
+	InsertListItem (tabHandle_FFT, spectrumRing, -1, "Amplitude", SPECTRUM_AMPLITUDE);
+	InsertListItem (tabHandle_FFT, spectrumRing, -1, "Welch PSD", SPECTRUM_WELCH_PSD);
+
+	// Spectra averaged into the plot, below the spectrum type
+	segmentsIndicator = NewCtrl (tabHandle_FFT, CTRL_NUMERIC_LS, "Averaged segments", top + 3 * (height + 25), left);
+	SetCtrlAttribute (tabHandle_FFT, segmentsIndicator, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (tabHandle_FFT, segmentsIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	// Live spectrogram, shares the place of the FFT graph
+	GetCtrlAttribute (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, ATTR_TOP, &top);
+	GetCtrlAttribute (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, ATTR_LEFT, &left);
+	GetCtrlAttribute (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, ATTR_HEIGHT, &height);
+	GetCtrlAttribute (tabHandle_FFT, TABPANEL_3_GRAPH_FFT, ATTR_WIDTH, &width);
+
+	spectrogramGraph = NewCtrl (tabHandle_FFT, CTRL_GRAPH_LS, "Spectrogram", top, left);
+	SetCtrlAttribute (tabHandle_FFT, spectrogramGraph, ATTR_HEIGHT, height);
+	SetCtrlAttribute (tabHandle_FFT, spectrogramGraph, ATTR_WIDTH, width);
+	SetCtrlAttribute (tabHandle_FFT, spectrogramGraph, ATTR_VISIBLE, 0);
+
+	// Open log button and replay speed, right of the select file button
+	GetCtrlAttribute (tabHandle_LiveChart, TABPANEL_SELECT_FILE, ATTR_TOP, &top);
+	GetCtrlAttribute (tabHandle_LiveChart, TABPANEL_SELECT_FILE, ATTR_LEFT, &left);
+	GetCtrlAttribute (tabHandle_LiveChart, TABPANEL_SELECT_FILE, ATTR_WIDTH, &width);
+
+	openLogButton = NewCtrl (tabHandle_LiveChart, CTRL_SQUARE_COMMAND_BUTTON_LS, "Open Log", top, left + width + 10);
+	InstallCtrlCallback (tabHandle_LiveChart, openLogButton, OpenLogCallback, NULL);
+	GetCtrlAttribute (tabHandle_LiveChart, openLogButton, ATTR_WIDTH, &width);
+
+	replaySpeedControl = NewCtrl (tabHandle_LiveChart, CTRL_NUMERIC_LS, "Replay speed", top, left + 2 * width + 30);
+	SetCtrlAttribute (tabHandle_LiveChart, replaySpeedControl, ATTR_DATA_TYPE, VAL_DOUBLE);
+	SetCtrlAttribute (tabHandle_LiveChart, replaySpeedControl, ATTR_MIN_VALUE, 0.1);
+	SetCtrlAttribute (tabHandle_LiveChart, replaySpeedControl, ATTR_MAX_VALUE, REPLAY_MAX_SPEED);
+	SetCtrlAttribute (tabHandle_LiveChart, replaySpeedControl, ATTR_CHECK_RANGE, VAL_COERCE);
+	SetCtrlVal (tabHandle_LiveChart, replaySpeedControl, 1.0);
+
+	// Table scrolling over the whole store, below the table
+	GetCtrlAttribute (tabHandle_3DGraph, TABPANEL_2_TABLE, ATTR_TOP, &top);
+	GetCtrlAttribute (tabHandle_3DGraph, TABPANEL_2_TABLE, ATTR_LEFT, &left);
+	GetCtrlAttribute (tabHandle_3DGraph, TABPANEL_2_TABLE, ATTR_HEIGHT, &height);
+	GetCtrlAttribute (tabHandle_3DGraph, TABPANEL_2_TABLE, ATTR_WIDTH, &width);
+
+	tableScroll = NewCtrl (tabHandle_3DGraph, CTRL_NUMERIC_LS, "First vector", top + height + 25, left);
+	SetCtrlAttribute (tabHandle_3DGraph, tableScroll, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (tabHandle_3DGraph, tableScroll, ATTR_INCR_VALUE, NUM_VECTORS);
+	SetCtrlAttribute (tabHandle_3DGraph, tableScroll, ATTR_MAX_VALUE, 0);
+	SetCtrlAttribute (tabHandle_3DGraph, tableScroll, ATTR_CHECK_RANGE, VAL_COERCE);
+	InstallCtrlCallback (tabHandle_3DGraph, tableScroll, TableScrollCallback, NULL);
+
+	followLatest = NewCtrl (tabHandle_3DGraph, CTRL_CHECK_BOX, "Follow latest", top + height + 25, left + width / 2);
+	SetCtrlVal (tabHandle_3DGraph, followLatest, 1);
+
+	// Replay clock, off until a log is opened
+	replayTimer = NewCtrl (panelHandle, CTRL_TIMER, "", 0, 0);
+	SetCtrlAttribute (panelHandle, replayTimer, ATTR_INTERVAL, REPLAY_INTERVAL);
+	SetCtrlAttribute (panelHandle, replayTimer, ATTR_ENABLED, 0);
+	InstallCtrlCallback (panelHandle, replayTimer, ReplayTimerCallback, NULL);
+
+	// Display refresh, on while acquiring
+	refreshTimer = NewCtrl (panelHandle, CTRL_TIMER, "", 0, 0);
+	SetCtrlAttribute (panelHandle, refreshTimer, ATTR_INTERVAL, REFRESH_INTERVAL);
+	SetCtrlAttribute (panelHandle, refreshTimer, ATTR_ENABLED, 0);
+	InstallCtrlCallback (panelHandle, refreshTimer, RefreshTimerCallback, NULL);
 }
 
 void ToggleConnectLED()
@@ -0,0 +1,259 @@
+//==============================================================================
+// Title:		Live spectrogram of the x, y, z vectors during acquisition.
+// Description:	See Spectrogram.h.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <analysis.h>
+#include <utility.h>
+#include <ansi_c.h>
+#include <userint.h>
+#include "Spectrogram.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define IDLE_WAIT			0.01 	// Seconds to wait when the queue is empty
+#define REDRAW_INTERVAL		0.1 	// Seconds between redraws
+#define DYNAMIC_RANGE_DB	80.0 	// Range covered by the color map
+#define MIN_POWER			1e-20 	// Floor to keep log10 finite
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+static int CVICALLBACK SpectrogramThreadFunction (void *functionData);
+static void ComputeColumn (Spectrogram *spectrogram);
+static void CVICALLBACK RedrawSpectrogram (void *callbackData);
+
+int SpectrogramInit (Spectrogram *spectrogram, int panel, int control)
+{
+	memset(spectrogram, 0, sizeof(*spectrogram));
+	spectrogram->panel = panel;
+	spectrogram->control = control;
+
+	SetCtrlAttribute (panel, control, ATTR_XNAME, "Time (s)");
+	SetCtrlAttribute (panel, control, ATTR_YNAME, "Frequency (Hz)");
+
+	if (CmtNewLock (NULL, 0, &spectrogram->lock) < 0)
+		return -1;
+	// One queue item is one x, y, z vector
+	if (CmtNewTSQ (SPECTROGRAM_QUEUE_SIZE, SPECTROGRAM_NUM_AXES * sizeof(double), 0, &spectrogram->queue) < 0)
+		return -1;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Clear the image and start the background thread for a new acquisition
+//-----------------------------------------------------------------------------
+void SpectrogramStart (Spectrogram *spectrogram, double fs)
+{
+	if (spectrogram->running)
+		return;
+
+	CmtFlushTSQ (spectrogram->queue, TSQ_FLUSH_ALL, NULL);
+	spectrogram->fs = fs;
+	spectrogram->numInput = 0;
+	spectrogram->head = 0;
+	spectrogram->numColumns = 0;
+	spectrogram->columnsComputed = 0;
+	spectrogram->redrawPending = 0;
+
+	if (spectrogram->plotHandle > 0)
+		DeleteGraphPlot (spectrogram->panel, spectrogram->control, spectrogram->plotHandle, VAL_IMMEDIATE_DRAW);
+	spectrogram->plotHandle = 0;
+
+	spectrogram->running = 1;
+	CmtScheduleThreadPoolFunction (DEFAULT_THREAD_POOL_HANDLE, SpectrogramThreadFunction, spectrogram,
+								   &spectrogram->threadFunctionId);
+}
+
+//-----------------------------------------------------------------------------
+// Forward received vectors. Never blocks: when the thread falls behind the
+// spectrogram skips data rather than delaying acquisition.
+//-----------------------------------------------------------------------------
+void SpectrogramFeed (Spectrogram *spectrogram, const double *vectors, int numVectors)
+{
+	if (spectrogram->running)
+		CmtWriteTSQData (spectrogram->queue, vectors, numVectors, 0, NULL);
+}
+
+void SpectrogramStop (Spectrogram *spectrogram)
+{
+	if (!spectrogram->running)
+		return;
+
+	spectrogram->running = 0;
+	CmtWaitForThreadPoolFunctionCompletion (DEFAULT_THREAD_POOL_HANDLE, spectrogram->threadFunctionId,
+											OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
+	CmtReleaseThreadPoolFunctionID (DEFAULT_THREAD_POOL_HANDLE, spectrogram->threadFunctionId);
+	spectrogram->threadFunctionId = 0;
+}
+
+void SpectrogramDiscard (Spectrogram *spectrogram)
+{
+	SpectrogramStop (spectrogram);
+	if (spectrogram->queue)
+		CmtDiscardTSQ (spectrogram->queue);
+	if (spectrogram->lock)
+		CmtDiscardLock (spectrogram->lock);
+	WindowCacheFree (&spectrogram->windows);
+	spectrogram->queue = 0;
+	spectrogram->lock = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Background thread: slide the input window by SPECTROGRAM_HOP vectors and
+// compute one column per hop
+//-----------------------------------------------------------------------------
+static int CVICALLBACK SpectrogramThreadFunction (void *functionData)
+{
+	Spectrogram *spectrogram = functionData;
+	double vectors[SPECTROGRAM_SEGMENT][SPECTROGRAM_NUM_AXES];
+	double lastRedraw = 0.0;
+	int numAvailable;
+	int numRead;
+	int numWanted;
+	int i, axis;
+
+	while (spectrogram->running)
+	{
+		CmtGetTSQAttribute (spectrogram->queue, ATTR_TSQ_ITEMS_IN_QUEUE, &numAvailable);
+		if (numAvailable <= 0)
+		{
+			Delay (IDLE_WAIT);
+			continue;
+		}
+
+		// Read up to the end of the current segment
+		numWanted = SPECTROGRAM_SEGMENT - spectrogram->numInput;
+		if (numWanted > numAvailable)
+			numWanted = numAvailable;
+		numRead = CmtReadTSQData (spectrogram->queue, vectors, numWanted, 0, 0);
+		if (numRead <= 0)
+			continue;
+
+		for (i = 0; i < numRead; i++, spectrogram->numInput++)
+			for (axis = 0; axis < SPECTROGRAM_NUM_AXES; axis++)
+				spectrogram->input[axis][spectrogram->numInput] = vectors[i][axis];
+
+		if (spectrogram->numInput < SPECTROGRAM_SEGMENT)
+			continue;
+
+		ComputeColumn (spectrogram);
+
+		// Keep the overlapping half for the next segment
+		for (axis = 0; axis < SPECTROGRAM_NUM_AXES; axis++)
+			memmove(spectrogram->input[axis], spectrogram->input[axis] + SPECTROGRAM_HOP,
+					(SPECTROGRAM_SEGMENT - SPECTROGRAM_HOP) * sizeof(double));
+		spectrogram->numInput = SPECTROGRAM_SEGMENT - SPECTROGRAM_HOP;
+
+		// Ask the UI thread for a redraw, at most one pending at a time
+		if (!spectrogram->redrawPending && Timer () - lastRedraw >= REDRAW_INTERVAL)
+		{
+			lastRedraw = Timer ();
+			spectrogram->redrawPending = 1;
+			PostDeferredCall (RedrawSpectrogram, spectrogram);
+		}
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Power of the x, y, z spectra of the current segment, stored in dB
+//-----------------------------------------------------------------------------
+static void ComputeColumn (Spectrogram *spectrogram)
+{
+	const WindowTable *table;
+	double *column;
+	double mean;
+	double scale;
+	int i, axis;
+
+	table = WindowCacheGet (&spectrogram->windows, WINDOW_HANN, SPECTROGRAM_SEGMENT);
+	if (!table)
+		return;
+
+	memset(spectrogram->power, 0, sizeof(spectrogram->power));
+	for (axis = 0; axis < SPECTROGRAM_NUM_AXES; axis++)
+	{
+		// Remove the static field so it doesn't leak over the whole image
+		for (i = 0, mean = 0.0; i < SPECTROGRAM_SEGMENT; i++)
+			mean += spectrogram->input[axis][i];
+		mean /= SPECTROGRAM_SEGMENT;
+
+		for (i = 0; i < SPECTROGRAM_SEGMENT; i++)
+			spectrogram->real[i] = (spectrogram->input[axis][i] - mean) * table->coefficients[i];
+
+		ReFFT (spectrogram->real, spectrogram->imag, SPECTROGRAM_SEGMENT);
+
+		for (i = 0; i < SPECTROGRAM_BINS; i++)
+			spectrogram->power[i] += spectrogram->real[i] * spectrogram->real[i]
+									 + spectrogram->imag[i] * spectrogram->imag[i];
+	}
+
+	// Amplitude scaling as in the whole-record spectrum
+	scale = 2.0 / table->sum;
+
+	CmtGetLock (spectrogram->lock);
+	column = spectrogram->image[spectrogram->head];
+	for (i = 0; i < SPECTROGRAM_BINS; i++)
+		column[i] = 10.0 * log10(spectrogram->power[i] * scale * scale + MIN_POWER);
+	spectrogram->head = (spectrogram->head + 1) % SPECTROGRAM_COLUMNS;
+	if (spectrogram->numColumns < SPECTROGRAM_COLUMNS)
+		spectrogram->numColumns++;
+	spectrogram->columnsComputed++;
+	CmtReleaseLock (spectrogram->lock);
+}
+
+//-----------------------------------------------------------------------------
+// Deferred call on the UI thread: unroll the image and draw it
+//-----------------------------------------------------------------------------
+static void CVICALLBACK RedrawSpectrogram (void *callbackData)
+{
+	Spectrogram *spectrogram = callbackData;
+	ColorMapEntry colors[5];
+	int colorValues[5] = { VAL_BLUE, VAL_CYAN, VAL_GREEN, VAL_YELLOW, VAL_RED };
+	double maxDb = -1e300;
+	double hopTime;
+	double xOffset;
+	int numColumns;
+	int first;
+	int i, j;
+
+	CmtGetLock (spectrogram->lock);
+	numColumns = spectrogram->numColumns;
+	first = (spectrogram->head - numColumns + SPECTROGRAM_COLUMNS) % SPECTROGRAM_COLUMNS;
+	for (j = 0; j < numColumns; j++)
+		for (i = 0; i < SPECTROGRAM_BINS; i++)
+		{
+			double value = spectrogram->image[(first + j) % SPECTROGRAM_COLUMNS][i];
+
+			spectrogram->plot[i * numColumns + j] = value;
+			if (value > maxDb)
+				maxDb = value;
+		}
+	xOffset = (double)(spectrogram->columnsComputed - numColumns);
+	CmtReleaseLock (spectrogram->lock);
+
+	spectrogram->redrawPending = 0;
+	if (numColumns == 0)
+		return;
+
+	// Spread the colors over the top DYNAMIC_RANGE_DB of the image
+	for (i = 0; i < 5; i++)
+	{
+		colors[i].dataValue.valDouble = maxDb - DYNAMIC_RANGE_DB * (4 - i) / 4.0;
+		colors[i].color = colorValues[i];
+	}
+
+	// Columns are SPECTROGRAM_HOP samples apart, rows one frequency bin apart
+	hopTime = SPECTROGRAM_HOP / spectrogram->fs;
+	if (spectrogram->plotHandle > 0)
+		DeleteGraphPlot (spectrogram->panel, spectrogram->control, spectrogram->plotHandle, VAL_DELAYED_DRAW);
+	spectrogram->plotHandle = PlotScaledIntensity (spectrogram->panel, spectrogram->control, spectrogram->plot,
+						  numColumns, SPECTROGRAM_BINS, VAL_DOUBLE,
+						  spectrogram->fs / SPECTROGRAM_SEGMENT, 0.0, hopTime, xOffset * hopTime,
+						  colors, VAL_BLACK, 5, 1, 0);
+}
@@ -0,0 +1,76 @@
+//==============================================================================
+// Title:		Live spectrogram of the x, y, z vectors during acquisition.
+// Description:	Vectors drained from the receive queue are forwarded to a
+//				second thread-safe queue read by a background thread. The
+//				thread computes overlapped, windowed FFTs of the combined
+//				x, y, z field and keeps the latest columns in a rolling image
+//				that is drawn on the UI thread at a limited rate.
+//==============================================================================
+
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <utility.h>
+#include "WindowTable.h"
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define SPECTROGRAM_NUM_AXES		3 						// x, y, z vector
+#define SPECTROGRAM_SEGMENT			256 					// Samples per FFT
+#define SPECTROGRAM_HOP				(SPECTROGRAM_SEGMENT / 2) // 50% overlap
+#define SPECTROGRAM_BINS			(SPECTROGRAM_SEGMENT / 2 + 1)
+#define SPECTROGRAM_COLUMNS			256 					// FFTs kept on screen
+#define SPECTROGRAM_QUEUE_SIZE		(64 * SPECTROGRAM_SEGMENT)
+
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+typedef struct
+{
+	int panel;
+	int control;
+	double fs;
+	CmtTSQHandle queue;								// Vectors waiting for the thread
+	CmtThreadFunctionID threadFunctionId;
+	CmtThreadLockHandle lock;						// Guards image, head and numColumns
+	int volatile running;
+	int volatile redrawPending;
+
+	// Background thread state
+	double input[SPECTROGRAM_NUM_AXES][SPECTROGRAM_SEGMENT];
+	double real[SPECTROGRAM_SEGMENT];
+	double imag[SPECTROGRAM_SEGMENT];
+	double power[SPECTROGRAM_BINS];
+	int numInput;
+	WindowCache windows;
+
+	// Rolling image of magnitudes in dB, one column per FFT
+	double image[SPECTROGRAM_COLUMNS][SPECTROGRAM_BINS];
+	int head;										// Next column to overwrite
+	int numColumns;
+	unsigned int columnsComputed;
+
+	// Image unrolled oldest first for plotting, frequency major
+	double plot[SPECTROGRAM_BINS * SPECTROGRAM_COLUMNS];
+	int plotHandle;
+} Spectrogram;
+
+//-----------------------------------------------------------------------------
+// Prototypes
+//-----------------------------------------------------------------------------
+int SpectrogramInit (Spectrogram *spectrogram, int panel, int control);
+void SpectrogramStart (Spectrogram *spectrogram, double fs);
+void SpectrogramFeed (Spectrogram *spectrogram, const double *vectors, int numVectors);
+void SpectrogramStop (Spectrogram *spectrogram);
+void SpectrogramDiscard (Spectrogram *spectrogram);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif /* SPECTROGRAM_H */
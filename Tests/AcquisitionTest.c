@@ -0,0 +1,167 @@
+//==============================================================================
+// Title:		Unit test of the monitor's receive path.
+// Description:	Feeds paced block frames, timestamped like the transmitter
+//				does, through the acquisition and checks the vectors, the
+//				sequence grid, the bridging of lost frames and the measured
+//				sampling rate.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "Check.h"
+#include "Acquisition.h"
+#include "Pacer.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define MAX_VECTORS		1024
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static double vectors[MAX_VECTORS * ACQUISITION_NUM_ELEMENTS];
+static double magnitudes[MAX_VECTORS];
+
+//-----------------------------------------------------------------------------
+// Frame count vectors from sequence first as the transmitter does, in blocks
+// of blockSize timestamped by the pacer, and decode them
+//-----------------------------------------------------------------------------
+static int Feed (Acquisition *acquisition, const Pacer *pacer, unsigned int first, int count, int blockSize)
+{
+	unsigned char frame[FRAME_MAX_SIZE];
+	FrameSample samples[FRAME_MAX_VECTORS];
+	unsigned char *space;
+	int numInFrame;
+	int frameSize;
+	int numBytes;
+	int numDecoded = 0;
+	int i, j;
+
+	for (i = 0; i < count; i += numInFrame)
+	{
+		numInFrame = count - i < blockSize ? count - i : blockSize;
+		for (j = 0; j < numInFrame; j++)
+		{
+			samples[j].sequence = first + i + j;
+			samples[j].timestamp = (unsigned long long)(PacerTime (pacer, first + i + j) / FRAME_TIMESTAMP_UNIT);
+			samples[j].vector[0] = first + i + j;
+			samples[j].vector[1] = 2.0;
+			samples[j].vector[2] = -1.0;
+		}
+		frameSize = FrameEncodeBlock (samples, numInFrame, FRAME_TYPE_FLOAT64, frame);
+
+		space = FrameDecoderSpace (&acquisition->decoder, &numBytes);
+		memcpy(space, frame, frameSize);
+		FrameDecoderCommit (&acquisition->decoder, frameSize);
+		numDecoded += AcquisitionDecode (acquisition, vectors + numDecoded * ACQUISITION_NUM_ELEMENTS,
+										 magnitudes + numDecoded, MAX_VECTORS - numDecoded);
+	}
+	return numDecoded;
+}
+
+//-----------------------------------------------------------------------------
+// The rate comes out right however the vectors are burst, and only once the
+// timestamps span enough time and vectors to trust it
+//-----------------------------------------------------------------------------
+static void TestRate (double rate, int blockSize)
+{
+	Acquisition acquisition;
+	Pacer pacer;
+	unsigned int sent;
+	int numDecoded;
+
+	AcquisitionInit (&acquisition);
+	PacerInit (&pacer, rate, (unsigned int)blockSize, 100.0);
+
+	// Too short to measure
+	numDecoded = Feed (&acquisition, &pacer, 0, (int)(rate / 2), blockSize);
+	CHECK(numDecoded == (int)(rate / 2));
+	CHECK(AcquisitionRate (&acquisition) == 0.0);
+
+	numDecoded = Feed (&acquisition, &pacer, (unsigned int)(rate / 2), blockSize, blockSize);
+	CHECK(numDecoded == blockSize);
+	CHECK(vectors[0] == (int)(rate / 2));
+	CHECK_NEAR(magnitudes[0], sqrt(vectors[0] * vectors[0] + 5.0), 1e-9);
+
+	// Known as soon as both the span and the vector count are reached
+	for (sent = (unsigned int)(rate / 2) + blockSize; AcquisitionRate (&acquisition) == 0.0; sent += blockSize)
+	{
+		CHECK(sent - 1 < ACQUISITION_MIN_RATE_VECTORS || (sent - 1) / rate < ACQUISITION_MIN_RATE_SPAN + 1e-3);
+		Feed (&acquisition, &pacer, sent, blockSize, blockSize);
+	}
+	CHECK(sent - 1 >= ACQUISITION_MIN_RATE_VECTORS);
+	CHECK((sent - 1) / rate > ACQUISITION_MIN_RATE_SPAN - 1e-3);
+	CHECK_NEAR(AcquisitionRate (&acquisition), rate, rate * 1e-4);
+}
+
+//-----------------------------------------------------------------------------
+// A few lost frames are interpolated and counted, a long run restarts the
+// grid instead of being made up
+//-----------------------------------------------------------------------------
+static void TestGaps (int blockSize)
+{
+	Acquisition acquisition;
+	Pacer pacer;
+	int numDecoded;
+	int i;
+
+	AcquisitionInit (&acquisition);
+	PacerInit (&pacer, 25.0, (unsigned int)blockSize, 100.0);
+
+	CHECK(Feed (&acquisition, &pacer, 0, 10, blockSize) == 10);
+	numDecoded = Feed (&acquisition, &pacer, 10 + ACQUISITION_MAX_GAP_FILL, 10, blockSize);
+	CHECK(numDecoded == ACQUISITION_MAX_GAP_FILL + 10);
+	for (i = 0; i < numDecoded; i++)
+		CHECK_NEAR(vectors[i * ACQUISITION_NUM_ELEMENTS], 10 + i, 1e-9);
+	CHECK(acquisition.missing == ACQUISITION_MAX_GAP_FILL);
+	CHECK(acquisition.interpolated == ACQUISITION_MAX_GAP_FILL);
+	CHECK(acquisition.gaps == 1);
+	CHECK(acquisition.restarts == 0);
+
+	numDecoded = Feed (&acquisition, &pacer, 21 + 2 * ACQUISITION_MAX_GAP_FILL, 10, blockSize);
+	CHECK(numDecoded == 10);
+	CHECK(vectors[0] == 21 + 2 * ACQUISITION_MAX_GAP_FILL);
+	CHECK(acquisition.missing == 2 * ACQUISITION_MAX_GAP_FILL + 1);
+	CHECK(acquisition.interpolated == ACQUISITION_MAX_GAP_FILL);
+	CHECK(acquisition.gaps == 2);
+	CHECK(acquisition.restarts == 1);
+}
+
+//-----------------------------------------------------------------------------
+// A whole block frame lost to a CRC error is bridged, the grid goes on
+//-----------------------------------------------------------------------------
+static void TestLostBlock (void)
+{
+	Acquisition acquisition;
+	Pacer pacer;
+	int numDecoded;
+	int i;
+
+	AcquisitionInit (&acquisition);
+	PacerInit (&pacer, 25.0, 16, 100.0);
+
+	CHECK(Feed (&acquisition, &pacer, 0, 32, 16) == 32);
+	numDecoded = Feed (&acquisition, &pacer, 48, 32, 16);
+	CHECK(numDecoded == 48);
+	for (i = 0; i < numDecoded; i++)
+		CHECK_NEAR(vectors[i * ACQUISITION_NUM_ELEMENTS], 32 + i, 1e-9);
+	CHECK(acquisition.missing == 16);
+	CHECK(acquisition.interpolated == 16);
+	CHECK(acquisition.gaps == 1);
+	CHECK(acquisition.restarts == 0);
+	CHECK(ACQUISITION_MAX_GAP_FILL >= FRAME_MAX_VECTORS);
+}
+
+int main (void)
+{
+	TestRate (25.0, 16);
+	TestRate (25.0, 1);
+	TestRate (400.0, 64);
+	TestGaps (1);
+	TestGaps (5);
+	TestLostBlock ();
+	return CHECK_RESULT;
+}
@@ -0,0 +1,30 @@
+//==============================================================================
+// Title:		Minimal checks for the MagnoCore unit tests.
+// Description:	A failed check prints its location and condition and the
+//				test goes on, so one run reports every failure. A test's
+//				main returns CHECK_RESULT, which CTest reads as pass or fail.
+//==============================================================================
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <math.h>
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define CHECK(condition) \
+	do { if (!(condition)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); checkFailures++; } } while (0)
+
+#define CHECK_NEAR(value, expected, tolerance) \
+	CHECK(fabs((double)(value) - (double)(expected)) <= (tolerance))
+
+#define CHECK_RESULT	(checkFailures ? 1 : 0)
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static int checkFailures = 0;
+
+#endif /* CHECK_H */
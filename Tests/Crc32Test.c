@@ -0,0 +1,22 @@
+//==============================================================================
+// Title:		Unit test of the CRC-32.
+// Description:	Checks the standard check value and that a CRC continues
+//				over data passed in pieces.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include "Check.h"
+#include "Crc32.h"
+
+int main (void)
+{
+	const unsigned char check[] = "123456789";
+
+	// Check value of CRC-32/ISO-HDLC
+	CHECK(Crc32 (0, check, 9) == 0xCBF43926u);
+	CHECK(Crc32 (Crc32 (0, check, 4), check + 4, 5) == 0xCBF43926u);
+	CHECK(Crc32 (0, check, 0) == 0);
+	return CHECK_RESULT;
+}
@@ -0,0 +1,87 @@
+//==============================================================================
+// Title:		Unit test of the min/max envelope decimation.
+// Description:	Feeds buckets split across feeds and checks that each pair
+//				comes out in the order its extremes occurred, that an open
+//				bucket carries over and flushes, and the bucket sizing.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include "Check.h"
+#include "Envelope.h"
+
+//-----------------------------------------------------------------------------
+// Buckets of 4 fed as 3, 6 and 3 samples: the pairs only come out once their
+// bucket is complete, minimum or maximum first as they occurred
+//-----------------------------------------------------------------------------
+static void TestFeedBoundaries (void)
+{
+	static const double samples[] = { 5, 1, 3, 9,  2, 8, 7, 0,  4, 4, 4, 4,  6, -1 };
+	static const double expected[] = { 1, 9,  8, 0,  4, 4,  6, -1 };
+	double points[ENVELOPE_MAX_POINTS(8)];
+	double all[8];
+	Envelope envelope;
+	size_t numPoints;
+	size_t total = 0;
+	size_t i;
+
+	EnvelopeInit (&envelope, 4);
+
+	numPoints = EnvelopeFeed (&envelope, samples, 3, points);
+	CHECK(numPoints == 0);
+
+	numPoints = EnvelopeFeed (&envelope, samples + 3, 6, points);
+	CHECK(numPoints == 4);
+	for (i = 0; i < numPoints && total < 8; i++)
+		all[total++] = points[i];
+
+	numPoints = EnvelopeFeed (&envelope, samples + 9, 5, points);
+	CHECK(numPoints == 2);
+	for (i = 0; i < numPoints && total < 8; i++)
+		all[total++] = points[i];
+
+	// The last two samples are an open bucket until flushed
+	numPoints = EnvelopeFlush (&envelope, points);
+	CHECK(numPoints == 2);
+	for (i = 0; i < numPoints && total < 8; i++)
+		all[total++] = points[i];
+	CHECK(EnvelopeFlush (&envelope, points) == 0);
+
+	CHECK(total == 8);
+	for (i = 0; i < total; i++)
+		CHECK(all[i] == expected[i]);
+}
+
+//-----------------------------------------------------------------------------
+// A bucket of 1 passes the samples through
+//-----------------------------------------------------------------------------
+static void TestPassThrough (void)
+{
+	static const double samples[] = { 3, -2, 7 };
+	double points[ENVELOPE_MAX_POINTS(3)];
+	Envelope envelope;
+
+	EnvelopeInit (&envelope, 0);
+	CHECK(envelope.bucketSize == 1);
+	CHECK(EnvelopeFeed (&envelope, samples, 3, points) == 3);
+	CHECK(points[0] == 3 && points[1] == -2 && points[2] == 7);
+	CHECK(EnvelopeFlush (&envelope, points) == 0);
+}
+
+static void TestBucketSize (void)
+{
+	CHECK(EnvelopeBucketSize (150.0, 100) == 1);	// Fewer than two samples per column
+	CHECK(EnvelopeBucketSize (200.0, 100) == 1);
+	CHECK(EnvelopeBucketSize (201.0, 100) == 3);
+	CHECK(EnvelopeBucketSize (100000.0, 800) == 125);
+	CHECK(EnvelopeBucketSize (1000.0, 0) == 1);
+}
+
+int main (void)
+{
+	TestFeedBoundaries ();
+	TestPassThrough ();
+	TestBucketSize ();
+	return CHECK_RESULT;
+}
@@ -0,0 +1,157 @@
+//==============================================================================
+// Title:		Unit test of the spectrum engine.
+// Description:	Checks that the whole-record spectrum puts sinusoids on bin
+//				centres at their amplitudes for every window, that the
+//				workspace is reused for a record that isn't longer, and that
+//				Welch's method scales white noise to its known density and
+//				reports the segments it averaged.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "Check.h"
+#include "FftEngine.h"
+#include "SampleStore.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define PI				3.14159265358979323846
+#define MAX_VECTORS		1024
+#define NOISE_AMPLITUDE	2.0 	// Uniform in [-a, a], variance a^2 / 3
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static double vectors[MAX_VECTORS * SAMPLE_STORE_NUM_ELEMENTS];
+
+//-----------------------------------------------------------------------------
+// A store of n vectors: a DC field, a sinusoid of amplitude 4 in bin 10 on x
+// and one of amplitude 3 in bin 50 on y
+//-----------------------------------------------------------------------------
+static void MakeStore (SampleStore *store, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+	{
+		vectors[i * 3] = 4.0 * sin(2.0 * PI * 10 * i / n);
+		vectors[i * 3 + 1] = 3.0 * cos(2.0 * PI * 50 * i / n);
+		vectors[i * 3 + 2] = 47083.0;
+	}
+	SampleStoreInit (store);
+	CHECK(SampleStoreAppend (store, vectors, n) == 0);
+}
+
+static void TestCompute (void)
+{
+	SampleStore store;
+	FftEngine engine;
+	double *memory;
+	int numBins;
+	int window;
+
+	memset(&engine, 0, sizeof(engine));
+	MakeStore (&store, MAX_VECTORS);
+	for (window = 0; window < WINDOW_NUM_TYPES; window++)
+	{
+		numBins = FftEngineCompute (&engine, &store, 256.0, (WindowType)window);
+		CHECK(numBins == MAX_VECTORS / 2 + 1);
+		if (numBins != MAX_VECTORS / 2 + 1)
+			continue;
+		CHECK_NEAR(engine.frequency[10], 10 * 256.0 / MAX_VECTORS, 1e-12);
+		CHECK_NEAR(engine.magnitude[10], 4.0, 1e-9);
+		CHECK_NEAR(engine.magnitude[50], 3.0, 1e-9);
+		CHECK_NEAR(engine.magnitude[0], 47083.0, 1e-6);
+		CHECK(engine.magnitude[200] < 1e-6);
+	}
+
+	// A shorter record keeps the workspace, also for a length that isn't a power of two
+	memory = (double*)engine.memory;
+	SampleStoreFree (&store);
+	MakeStore (&store, 1000);
+	numBins = FftEngineCompute (&engine, &store, 250.0, WINDOW_HANN);
+	CHECK(numBins == 501);
+	CHECK((double*)engine.memory == memory && engine.capacity == MAX_VECTORS);
+	CHECK_NEAR(engine.magnitude[10], 4.0, 1e-9);
+	CHECK_NEAR(engine.magnitude[50], 3.0, 1e-9);
+
+	FftEngineFree (&engine);
+	SampleStoreFree (&store);
+}
+
+//-----------------------------------------------------------------------------
+// Uniform noise in [-NOISE_AMPLITUDE, NOISE_AMPLITUDE] from a fixed xorshift
+//-----------------------------------------------------------------------------
+static double Noise (unsigned int *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return NOISE_AMPLITUDE * (2.0 * (*state / 4294967295.0) - 1.0);
+}
+
+//-----------------------------------------------------------------------------
+// White noise of variance s^2 on each axis has a one-sided density of
+// 2 s^2 / fs per axis, so the summed density is 6 s^2 / fs
+//-----------------------------------------------------------------------------
+static void TestWelch (void)
+{
+	SampleStore store;
+	FftEngine engine;
+	unsigned int state = 2463534242u;
+	double expected = 6.0 * (NOISE_AMPLITUDE * NOISE_AMPLITUDE / 3.0) / 256.0;
+	double density;
+	size_t i;
+	int numBins;
+
+	memset(&engine, 0, sizeof(engine));
+	for (i = 0; i < MAX_VECTORS * SAMPLE_STORE_NUM_ELEMENTS; i++)
+		vectors[i] = Noise (&state);
+	SampleStoreInit (&store);
+	CHECK(SampleStoreAppend (&store, vectors, MAX_VECTORS) == 0);
+
+	// 1024 vectors give segments of 128 with 50% overlap
+	numBins = FftEngineWelch (&engine, &store, 256.0, WINDOW_HANN);
+	CHECK(numBins == 65);
+	CHECK(engine.numSegments == 15);
+	if (numBins == 65)
+	{
+		CHECK_NEAR(engine.frequency[1], 2.0, 1e-12);
+		for (i = 1, density = 0.0; i < 64; i++)
+			density += engine.magnitude[i] * engine.magnitude[i];
+		density /= 63;
+		CHECK_NEAR(density / expected, 1.0, 0.1);
+	}
+	SampleStoreFree (&store);
+
+	// The shortest record takes a single segment, a shorter one none
+	SampleStoreInit (&store);
+	CHECK(SampleStoreAppend (&store, vectors, WELCH_MIN_SEGMENT) == 0);
+	CHECK(FftEngineWelch (&engine, &store, 256.0, WINDOW_HANN) == WELCH_MIN_SEGMENT / 2 + 1);
+	CHECK(engine.numSegments == 1);
+	SampleStoreFree (&store);
+
+	SampleStoreInit (&store);
+	CHECK(SampleStoreAppend (&store, vectors, WELCH_MIN_SEGMENT - 1) == 0);
+	CHECK(FftEngineWelch (&engine, &store, 256.0, WINDOW_HANN) == 0);
+	CHECK(engine.numSegments == 0);
+	SampleStoreFree (&store);
+
+	// The whole-record spectrum is a single one
+	MakeStore (&store, MAX_VECTORS);
+	CHECK(FftEngineCompute (&engine, &store, 256.0, WINDOW_HANN) == MAX_VECTORS / 2 + 1);
+	CHECK(engine.numSegments == 1);
+
+	FftEngineFree (&engine);
+	SampleStoreFree (&store);
+}
+
+int main (void)
+{
+	TestCompute ();
+	TestWelch ();
+	return CHECK_RESULT;
+}
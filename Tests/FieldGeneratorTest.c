@@ -0,0 +1,208 @@
+//==============================================================================
+// Title:		Unit test of the synthetic field generator.
+// Description:	Checks the generator against the ground truth it promises:
+//				tones land in their spectrum bin at their amplitude, a tone
+//				stays phase continuous across a change of fs, the white noise
+//				floor has the configured density, and the white and 1/f noise
+//				are unit scaled and independent.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include "Check.h"
+#include "FieldGenerator.h"
+#include "FftEngine.h"
+#include "SampleStore.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define PI				3.14159265358979323846
+#define MAX_VECTORS		262144
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static FieldGenerator generator;
+static double vectors[MAX_VECTORS * GENERATOR_NUM_ELEMENTS];
+
+//-----------------------------------------------------------------------------
+// A model with nothing in it
+//-----------------------------------------------------------------------------
+static void EmptyModel (GeneratorModel *model)
+{
+	memset(model, 0, sizeof(*model));
+}
+
+//-----------------------------------------------------------------------------
+// Mean and variance of one axis of count vectors from first
+//-----------------------------------------------------------------------------
+static double Variance (int axis, size_t first, size_t count, double *mean)
+{
+	double sum = 0.0;
+	double sumOfSquares = 0.0;
+	double value;
+	size_t i;
+
+	for (i = first; i < first + count; i++)
+	{
+		value = vectors[i * GENERATOR_NUM_ELEMENTS + axis];
+		sum += value;
+		sumOfSquares += value * value;
+	}
+	*mean = sum / count;
+	return sumOfSquares / count - *mean * *mean;
+}
+
+//-----------------------------------------------------------------------------
+// Tones and mains harmonics on bin centres come out of the spectrum in their
+// bins at their amplitudes, with nothing in between
+//-----------------------------------------------------------------------------
+static void TestTones (void)
+{
+	const double fs = 1024.0;
+	const size_t n = 4096;
+	GeneratorModel model;
+	SampleStore store;
+	FftEngine engine;
+	int numBins;
+	int i;
+
+	EmptyModel (&model);
+	model.numTones = 2;
+	model.tones[0].frequency = 10.0;
+	model.tones[0].amplitude[0] = 5.0;
+	model.tones[1].frequency = 200.25;
+	model.tones[1].amplitude[1] = 3.0;
+	model.mainsFrequency = 50.0;
+	model.mainsAmplitude[2] = 2.0;
+	model.numHarmonics = 3;
+	model.tones[2].frequency = 400.0;	// Unused, beyond numTones
+	model.tones[2].amplitude[0] = 100.0;
+
+	GeneratorInit (&generator, &model, fs);
+	GeneratorFill (&generator, vectors, n);
+	SampleStoreInit (&store);
+	CHECK(SampleStoreAppend (&store, vectors, n) == 0);
+
+	memset(&engine, 0, sizeof(engine));
+	numBins = FftEngineCompute (&engine, &store, fs, WINDOW_HANN);
+	CHECK(numBins == (int)(n / 2 + 1));
+	for (i = 0; i < numBins; i++)
+	{
+		if (i == 40)
+			CHECK_NEAR(engine.magnitude[i], 5.0, 1e-6);
+		else if (i == 801)
+			CHECK_NEAR(engine.magnitude[i], 3.0, 1e-6);
+		else if (i == 200 || i == 400 || i == 600)
+			CHECK_NEAR(engine.magnitude[i], 2.0 / (i / 200), 1e-6);
+		else if (abs(i - 40) > 1 && abs(i - 801) > 1 && abs(i - 200) > 1 && abs(i - 400) > 1 && abs(i - 600) > 1)
+			CHECK(engine.magnitude[i] < 1e-6); // Hann leaks into the neighbour bins only
+	}
+
+	FftEngineFree (&engine);
+	SampleStoreFree (&store);
+}
+
+//-----------------------------------------------------------------------------
+// A tone goes on from the phase it reached when the rate changes
+//-----------------------------------------------------------------------------
+static void TestPhaseContinuity (void)
+{
+	const double fs1 = 100.0, fs2 = 37.0, frequency = 3.3;
+	const size_t n1 = 1000 + 17, n2 = 500;
+	GeneratorModel model;
+	double phase;
+	size_t i;
+
+	EmptyModel (&model);
+	model.numTones = 1;
+	model.tones[0].frequency = frequency;
+	model.tones[0].amplitude[0] = 1.0;
+
+	GeneratorInit (&generator, &model, fs1);
+	GeneratorFill (&generator, vectors, n1);
+	for (i = 0; i < n1; i++)
+		CHECK_NEAR(vectors[i * GENERATOR_NUM_ELEMENTS], sin(2.0 * PI * frequency * i / fs1), 1e-9);
+
+	GeneratorSetModel (&generator, &model, fs2);
+	GeneratorFill (&generator, vectors, n2);
+	for (i = 0; i < n2; i++)
+	{
+		phase = frequency * n1 / fs1 + frequency * i / fs2;
+		CHECK_NEAR(vectors[i * GENERATOR_NUM_ELEMENTS], sin(2.0 * PI * (phase - floor(phase))), 1e-9);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// White noise of sigma nT rms per axis has a flat one-sided density of
+// sigma sqrt(2 / fs) per axis, and the engine sums the three axes
+//-----------------------------------------------------------------------------
+static void TestWhiteFloor (void)
+{
+	const double fs = 100.0, sigma = 0.5;
+	const size_t n = 131072;
+	GeneratorModel model;
+	SampleStore store;
+	FftEngine engine;
+	double mean = 0.0;
+	int numBins;
+	int i;
+
+	EmptyModel (&model);
+	model.offset[2] = 47083.0;	// Removed per segment
+	model.whiteNoise = sigma;
+
+	GeneratorInit (&generator, &model, fs);
+	GeneratorFill (&generator, vectors, n);
+	SampleStoreInit (&store);
+	CHECK(SampleStoreAppend (&store, vectors, n) == 0);
+
+	memset(&engine, 0, sizeof(engine));
+	numBins = FftEngineWelch (&engine, &store, fs, WINDOW_HANN);
+	CHECK(numBins > 2);
+	for (i = 1; i < numBins - 1; i++)
+		mean += engine.magnitude[i] * engine.magnitude[i];
+	mean /= numBins - 2;
+	CHECK_NEAR(sqrt(mean), sigma * sqrt(3 * 2.0 / fs), 0.03 * sigma * sqrt(3 * 2.0 / fs));
+
+	FftEngineFree (&engine);
+	SampleStoreFree (&store);
+}
+
+//-----------------------------------------------------------------------------
+// 1/f noise of 1 nT rms has unit variance, and added to white noise of 1 nT
+// rms the variances add, which they only do for independent components
+//-----------------------------------------------------------------------------
+static void TestNoiseLevels (void)
+{
+	const size_t settle = 10000, n = MAX_VECTORS;
+	GeneratorModel model;
+	double mean;
+	int axis;
+
+	EmptyModel (&model);
+	model.pinkNoise = 1.0;
+	GeneratorInit (&generator, &model, 1000.0);
+	GeneratorFill (&generator, vectors, n);
+	for (axis = 0; axis < GENERATOR_NUM_ELEMENTS; axis++)
+		CHECK_NEAR(Variance (axis, settle, n - settle, &mean), 1.0, 0.15);
+
+	model.whiteNoise = 1.0;
+	GeneratorInit (&generator, &model, 1000.0);
+	GeneratorFill (&generator, vectors, n);
+	for (axis = 0; axis < GENERATOR_NUM_ELEMENTS; axis++)
+		CHECK_NEAR(Variance (axis, settle, n - settle, &mean), 2.0, 0.2);
+}
+
+int main (void)
+{
+	TestTones ();
+	TestPhaseContinuity ();
+	TestWhiteFloor ();
+	TestNoiseLevels ();
+	return CHECK_RESULT;
+}
@@ -0,0 +1,201 @@
+//==============================================================================
+// Title:		Unit test of the frame codec.
+// Description:	Round-trips single-vector frames in both encodings and block
+//				frames through the decoder, fed in small pieces, and checks
+//				that frames with a bad check byte or CRC are dropped while
+//				the decoder resynchronizes on the next frame, and that a
+//				decoder joining a stream waits for an anchor frame.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "Check.h"
+#include "MagnoFrame.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define NUM_SAMPLES		40
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static unsigned char stream[NUM_SAMPLES * FRAME_MAX_VECTOR_COST];
+static FrameSample decoded[2 * NUM_SAMPLES];
+
+//-----------------------------------------------------------------------------
+// Sample n of a test signal, within the fixed-point range. Sample 0 goes out
+// as an anchor frame like a sender's first one.
+//-----------------------------------------------------------------------------
+static void MakeSample (FrameSample *sample, unsigned int n)
+{
+	sample->sequence = FRAME_ANCHOR_INTERVAL + n;
+	sample->timestamp = 5000000ull + 40000ull * n;
+	sample->vector[0] = 20527.13 + n;
+	sample->vector[1] = -2882.57 - 0.01 * n;
+	sample->vector[2] = 47083.99;
+}
+
+//-----------------------------------------------------------------------------
+// Feed size bytes to a fresh decoder a few at a time. Returns the number of
+// samples decoded.
+//-----------------------------------------------------------------------------
+static int Decode (FrameDecoder *decoder, const unsigned char *bytes, int size)
+{
+	unsigned char *space;
+	int numDecoded = 0;
+	int numBytes;
+	int piece;
+
+	FrameDecoderInit (decoder);
+	while (size > 0)
+	{
+		space = FrameDecoderSpace (decoder, &numBytes);
+		piece = size < 7 ? size : 7;
+		memcpy(space, bytes, piece);
+		FrameDecoderCommit (decoder, piece);
+		bytes += piece;
+		size -= piece;
+		while (numDecoded < 2 * NUM_SAMPLES && FrameDecoderNext (decoder, &decoded[numDecoded]))
+			numDecoded++;
+	}
+	return numDecoded;
+}
+
+//-----------------------------------------------------------------------------
+// Whether decoded sample n matches the one sent, to the encoding's resolution
+//-----------------------------------------------------------------------------
+static int SameSample (const FrameSample *sample, unsigned int n, double resolution)
+{
+	FrameSample sent;
+	int i;
+
+	MakeSample (&sent, n);
+	if (sample->sequence != sent.sequence || sample->timestamp != sent.timestamp)
+		return 0;
+	for (i = 0; i < FRAME_NUM_ELEMENTS; i++)
+		if (fabs(sample->vector[i] - sent.vector[i]) > resolution)
+			return 0;
+	return 1;
+}
+
+static void TestSingleFrames (int type, double resolution)
+{
+	FrameDecoder decoder;
+	FrameSample sample;
+	int size = 0;
+	int numDecoded;
+	int i;
+
+	for (i = 0; i < NUM_SAMPLES; i++)
+	{
+		MakeSample (&sample, i);
+		size += FrameEncode (&sample, type, stream + size);
+	}
+
+	numDecoded = Decode (&decoder, stream, size);
+	CHECK(numDecoded == NUM_SAMPLES);
+	for (i = 0; i < numDecoded; i++)
+		CHECK(SameSample (&decoded[i], i, resolution));
+	CHECK(decoder.framesDropped == 0);
+	CHECK(decoder.bytesSkipped == 0);
+}
+
+static void TestBlockFrames (int type, double resolution)
+{
+	FrameSample samples[NUM_SAMPLES];
+	FrameDecoder decoder;
+	int size = 0;
+	int numDecoded;
+	int i;
+
+	for (i = 0; i < NUM_SAMPLES; i++)
+		MakeSample (&samples[i], i);
+	size += FrameEncodeBlock (samples, 16, type, stream);
+	size += FrameEncodeBlock (samples + 16, NUM_SAMPLES - 16, type, stream + size);
+	CHECK(size == FrameSize (FRAME_TYPE_BLOCK | type, 16) + FrameSize (FRAME_TYPE_BLOCK | type, NUM_SAMPLES - 16));
+	CHECK(FrameEncodeBlock (samples, 0, type, stream + size) == 0);
+	CHECK(FrameEncodeBlock (samples, FRAME_MAX_VECTORS + 1, type, stream + size) == 0);
+
+	numDecoded = Decode (&decoder, stream, size);
+	CHECK(numDecoded == NUM_SAMPLES);
+	for (i = 0; i < numDecoded; i++)
+		CHECK(SameSample (&decoded[i], i, resolution));
+	CHECK(decoder.framesDecoded == 2);
+}
+
+//-----------------------------------------------------------------------------
+// Corrupt the payload of the third of four frames, after the anchor and a
+// fixed-point one: it is dropped, the frames around it still decode
+//-----------------------------------------------------------------------------
+static void TestBadCheck (int type, int block)
+{
+	FrameSample samples[4];
+	FrameDecoder decoder;
+	int sizes[4];
+	int size = 0;
+	int numDecoded;
+	int i;
+
+	for (i = 0; i < 4; i++)
+	{
+		MakeSample (&samples[i], i);
+		sizes[i] = block ? FrameEncodeBlock (samples + i, 1, type, stream + size) : FrameEncode (samples + i, type, stream + size);
+		size += sizes[i];
+	}
+	stream[sizes[0] + sizes[1] + sizes[2] - 3] ^= 0x40;
+
+	numDecoded = Decode (&decoder, stream, size);
+	CHECK(numDecoded == 3);
+	CHECK(numDecoded == 3 && SameSample (&decoded[0], 0, 0.01) && SameSample (&decoded[1], 1, 0.01)
+		  && SameSample (&decoded[2], 3, 0.01));
+	CHECK(decoder.framesDropped == 1);
+}
+
+//-----------------------------------------------------------------------------
+// Join a fixed-point stream in the middle, long after the sequence number and
+// the timestamp outgrew their truncated fields: the frames before the next
+// anchor are dropped instead of extended from nothing
+//-----------------------------------------------------------------------------
+static void TestMidStream (void)
+{
+	FrameSample sample;
+	FrameDecoder decoder;
+	unsigned int first = 40 * FRAME_ANCHOR_INTERVAL - 10;
+	int size = 0;
+	int numDecoded;
+	int i;
+
+	for (i = 0; i < 20; i++)
+	{
+		MakeSample (&sample, i);
+		sample.sequence = first + i;
+		sample.timestamp = 3000000000ull + 40000ull * i;
+		size += FrameEncode (&sample, FRAME_TYPE_FIXED24, stream + size);
+	}
+
+	numDecoded = Decode (&decoder, stream, size);
+	CHECK(numDecoded == 10);
+	CHECK(decoder.framesUnanchored == 10);
+	CHECK(decoder.framesDropped == 0);
+	for (i = 0; i < numDecoded; i++)
+	{
+		CHECK(decoded[i].sequence == first + 10 + i);
+		CHECK(decoded[i].timestamp == 3000000000ull + 40000ull * (10 + i));
+	}
+}
+
+int main (void)
+{
+	TestSingleFrames (FRAME_TYPE_FLOAT64, 0.0);
+	TestSingleFrames (FRAME_TYPE_FIXED24, FRAME_FIXED_LSB / 2);
+	TestBlockFrames (FRAME_TYPE_FLOAT64, 0.0);
+	TestBlockFrames (FRAME_TYPE_FIXED24, FRAME_FIXED_LSB / 2);
+	TestBadCheck (FRAME_TYPE_FLOAT64, 0);
+	TestBadCheck (FRAME_TYPE_FIXED24, 0);
+	TestBadCheck (FRAME_TYPE_FIXED24, 1);
+	TestMidStream ();
+	return CHECK_RESULT;
+}
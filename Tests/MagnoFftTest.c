@@ -0,0 +1,80 @@
+//==============================================================================
+// Title:		Unit test of the portable FFT.
+// Description:	Compares the transform of a pseudo-random signal with a
+//				direct DFT for power-of-two lengths and for lengths taken
+//				through Bluestein's algorithm, and reuses one plan across
+//				length changes.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include "Check.h"
+#include "MagnoFft.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define PI				3.14159265358979323846
+#define MAX_LENGTH		1000
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static double signal[MAX_LENGTH];
+static double real[MAX_LENGTH];
+static double imag[MAX_LENGTH];
+
+//-----------------------------------------------------------------------------
+// Largest difference between the plan's transform and a direct DFT,
+// relative to the largest bin
+//-----------------------------------------------------------------------------
+static double TransformError (FftPlan *plan, size_t length)
+{
+	double dftReal, dftImag, error = 0, peak = 0;
+	size_t k, n;
+
+	for (n = 0; n < length; n++)
+	{
+		signal[n] = rand() / (double)RAND_MAX - 0.5 + (n % 7 == 0);
+		real[n] = signal[n];
+		imag[n] = 0;
+	}
+	if (FftPlanPrepare (plan, length) < 0)
+		return 1.0;
+	FftPlanExecute (plan, real, imag);
+
+	for (k = 0; k < length; k++)
+	{
+		dftReal = dftImag = 0;
+		for (n = 0; n < length; n++)
+		{
+			dftReal += signal[n] * cos(2 * PI * (double)(k * n % length) / length);
+			dftImag -= signal[n] * sin(2 * PI * (double)(k * n % length) / length);
+		}
+		error = fmax(error, fmax(fabs(real[k] - dftReal), fabs(imag[k] - dftImag)));
+		peak = fmax(peak, hypot(dftReal, dftImag));
+	}
+	return error / peak;
+}
+
+int main (void)
+{
+	static const size_t lengths[] = { 1, 2, 3, 5, 12, 64, 100, 127, 256, 1000, 7 };
+	FftPlan plan;
+	size_t i;
+
+	srand (1);
+	FftPlanInit (&plan);
+	for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+	{
+		double error = TransformError (&plan, lengths[i]);
+
+		if (error > 1e-9)
+			fprintf(stderr, "length %u: relative error %g\n", (unsigned int)lengths[i], error);
+		CHECK(error <= 1e-9);
+	}
+	FftPlanFree (&plan);
+	return CHECK_RESULT;
+}
@@ -0,0 +1,119 @@
+//==============================================================================
+// Title:		Unit test of the text to binary log conversion.
+// Description:	Converts text logs that cross a midnight, span less than a
+//				second, or hold no rows, and checks the vectors, the
+//				estimated sampling rate and the start time in the header.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "Check.h"
+#include "MagnoLog.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define TEXT_PATHNAME	"MagnoLogTest.txt"
+#define LOG_PATHNAME	"MagnoLogTest" MAGNO_LOG_EXTENSION
+#define LAST_DAY		3.8e9 	// Midnight on the day of the last row
+#define ROWS_PER_SECOND	4
+#define NUM_ROWS		(2 + 3 * ROWS_PER_SECOND + 1)
+
+static int WriteFile (const char *contents)
+{
+	FILE *file = fopen (TEXT_PATHNAME, "wb");
+	size_t size = strlen (contents);
+
+	if (!file)
+		return -1;
+	if (fwrite(contents, 1, size, file) != size)
+		size = 0;
+	return fclose (file) == 0 && size ? 0 : -1;
+}
+
+//-----------------------------------------------------------------------------
+// Four rows a second from the last two rows of 23:59:58 to the first row of
+// 00:00:02. The rate comes from the rows between the first and the last
+// change of the second, the start time from the day before lastDay.
+//-----------------------------------------------------------------------------
+static void TestMidnight (void)
+{
+	static const char *times[] = { "23:59:58", "23:59:59", "00:00:00", "00:00:01", "00:00:02" };
+	static char text[1024];
+	MagnoLogReader reader;
+	char *cursor = text;
+	int row;
+	int second;
+
+	cursor += sprintf(cursor, "Time \t\t x \t\t y\t\t z \n");
+	for (row = 0; row < NUM_ROWS; row++)
+	{
+		// Rows 0, 1 in 23:59:58, then ROWS_PER_SECOND in each second
+		second = row < 2 ? 0 : 1 + (row - 2) / ROWS_PER_SECOND;
+		cursor += sprintf(cursor, "%s \t %d.00 \t %d.50 \t -%d.00\n", times[second], row, row, row);
+	}
+
+	CHECK(WriteFile (text) == 0);
+	CHECK(MagnoLogConvertText (TEXT_PATHNAME, LOG_PATHNAME, 10.0, LAST_DAY) == 0);
+	CHECK(MagnoLogOpen (&reader, LOG_PATHNAME) == 0);
+	CHECK(reader.numVectors == NUM_ROWS);
+	CHECK(reader.header.headerSize == MAGNO_LOG_HEADER_SIZE);
+	CHECK_NEAR(reader.header.fs, ROWS_PER_SECOND, 1e-12);
+	CHECK_NEAR(reader.header.startTime, LAST_DAY - 86400.0 + (23 * 3600 + 59 * 60 + 58), 1e-6);
+	if (reader.numVectors == NUM_ROWS)
+		for (row = 0; row < NUM_ROWS; row++)
+		{
+			CHECK(reader.vectors[row * MAGNO_LOG_NUM_ELEMENTS] == row);
+			CHECK(reader.vectors[row * MAGNO_LOG_NUM_ELEMENTS + 1] == row + 0.5);
+			CHECK(reader.vectors[row * MAGNO_LOG_NUM_ELEMENTS + 2] == -row);
+		}
+	MagnoLogClose (&reader);
+}
+
+//-----------------------------------------------------------------------------
+// Rows within a single second keep the default rate, and the day isn't moved
+//-----------------------------------------------------------------------------
+static void TestDefaultRate (void)
+{
+	static const char text[] =
+		"12:00:00 1 2 3\n"
+		"12:00 9 9 9\n"						// Broken time
+		"12:00:00 4 5 6";					// No newline at the end
+	MagnoLogReader reader;
+
+	CHECK(WriteFile (text) == 0);
+	CHECK(MagnoLogConvertText (TEXT_PATHNAME, LOG_PATHNAME, 10.0, LAST_DAY) == 0);
+	CHECK(MagnoLogOpen (&reader, LOG_PATHNAME) == 0);
+	CHECK(reader.numVectors == 2);
+	CHECK(reader.header.fs == 10.0);
+	CHECK_NEAR(reader.header.startTime, LAST_DAY + 12 * 3600, 1e-6);
+	if (reader.numVectors == 2)
+		CHECK(reader.vectors[0] == 1 && reader.vectors[5] == 6);
+	MagnoLogClose (&reader);
+}
+
+//-----------------------------------------------------------------------------
+// A file without rows leaves no log behind, a missing file can't be converted
+//-----------------------------------------------------------------------------
+static void TestRejected (void)
+{
+	MagnoLogReader reader;
+
+	CHECK(WriteFile ("no\nrows 1 2 3\n") == 0);
+	CHECK(MagnoLogConvertText (TEXT_PATHNAME, LOG_PATHNAME, 10.0, LAST_DAY) == MAGNO_LOG_ERROR_FORMAT);
+	CHECK(MagnoLogOpen (&reader, LOG_PATHNAME) == MAGNO_LOG_ERROR_FILE);
+	CHECK(MagnoLogConvertText ("MagnoLogTest.missing", LOG_PATHNAME, 10.0, LAST_DAY) == MAGNO_LOG_ERROR_FILE);
+}
+
+int main (void)
+{
+	TestMidnight ();
+	TestDefaultRate ();
+	TestRejected ();
+	remove (TEXT_PATHNAME);
+	remove (LOG_PATHNAME);
+	return CHECK_RESULT;
+}
@@ -0,0 +1,85 @@
+//==============================================================================
+// Title:		Unit test of the deadline pacer.
+// Description:	Drives the pacer with a simulated clock: vectors released on
+//				schedule, catching up after a short delay, held back by the
+//				caller's limit, a restart after falling too far behind,
+//				bursts, a rate change and a pause.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include "Check.h"
+#include "Pacer.h"
+
+static void TestSchedule (void)
+{
+	Pacer pacer;
+
+	PacerInit (&pacer, 100.0, 1, 10.0);
+	CHECK(PacerDue (&pacer, 9.0, 1000) == 0);			// Before the origin
+	CHECK(PacerDue (&pacer, 10.0, 1000) == 1);			// Vector 0 at the origin
+	CHECK(PacerDue (&pacer, 10.0, 1000) == 0);
+	CHECK_NEAR(PacerNextDeadline (&pacer, 10.0), 10.01, 1e-9);
+	CHECK(PacerDue (&pacer, 10.095, 1000) == 9);		// Vectors 1 to 9
+	CHECK_NEAR(PacerTime (&pacer, 9), 10.09, 1e-9);
+
+	// A short delay is caught up at once
+	CHECK(PacerDue (&pacer, 10.2005, 1000) == 11);
+	CHECK(pacer.slips == 0);
+
+	// Vectors held back by the caller stay due
+	CHECK(PacerDue (&pacer, 10.3005, 4) == 4);
+	CHECK(PacerDue (&pacer, 10.3005, 1000) == 6);
+	CHECK_NEAR(PacerNextDeadline (&pacer, 10.3005), 10.31, 1e-9);
+
+	// Far behind, the schedule restarts from now instead of flooding the link
+	CHECK(PacerDue (&pacer, 11.0, 1000) == 1);
+	CHECK(pacer.slips == 1);
+	CHECK_NEAR(pacer.origin, 11.0, 1e-12);
+	CHECK(PacerDue (&pacer, 11.0499, 1000) == 4);
+	CHECK(pacer.slips == 1);
+}
+
+static void TestBursts (void)
+{
+	Pacer pacer;
+
+	PacerInit (&pacer, 100.0, 10, 0.0);
+	CHECK(PacerDue (&pacer, 0.0, 1000) == 10);
+	CHECK(PacerDue (&pacer, 0.099, 1000) == 0);
+	CHECK_NEAR(PacerNextDeadline (&pacer, 0.099), 0.1, 1e-9);
+	CHECK(PacerDue (&pacer, 0.1, 1000) == 10);
+
+	// Vectors of a burst are sent together but keep their own times
+	CHECK_NEAR(PacerTime (&pacer, 10), 0.1, 1e-12);
+	CHECK_NEAR(PacerTime (&pacer, 19), 0.19, 1e-12);
+
+	// A partly released burst is due at once
+	CHECK(PacerDue (&pacer, 0.2, 3) == 3);
+	CHECK_NEAR(PacerNextDeadline (&pacer, 0.2), 0.2, 1e-9);
+	CHECK(PacerDue (&pacer, 0.2, 1000) == 7);
+
+	// A new rate starts a new schedule
+	PacerSetRate (&pacer, 1000.0, 1, 1.0);
+	CHECK(PacerDue (&pacer, 1.0099, 1000) == 10);
+	CHECK(pacer.slips == 0);
+}
+
+static void TestPause (void)
+{
+	Pacer pacer;
+
+	PacerInit (&pacer, 0.0, 1, 0.0);
+	CHECK(PacerDue (&pacer, 100.0, 1000) == 0);
+	CHECK(PacerNextDeadline (&pacer, 100.0) > 100.0);
+	CHECK_NEAR(PacerMaxRate (115200, 10, 24), 480.0, 1e-9);
+}
+
+int main (void)
+{
+	TestSchedule ();
+	TestBursts ();
+	TestPause ();
+	return CHECK_RESULT;
+}
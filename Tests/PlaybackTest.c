@@ -0,0 +1,98 @@
+//==============================================================================
+// Title:		Unit test of the playback engine.
+// Description:	Plays a range of numbered vectors in loop, ping-pong and
+//				stop mode, at other speeds, and seeks within and beyond it.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include "Check.h"
+#include "Playback.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define NUM_VECTORS		10
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static double vectors[NUM_VECTORS * PLAYBACK_NUM_ELEMENTS];
+
+//-----------------------------------------------------------------------------
+// Index of the next vector played, -1 for none
+//-----------------------------------------------------------------------------
+static int Next (Playback *playback)
+{
+	const double *vector = PlaybackNext (playback);
+
+	return vector ? (int)vector[0] : -1;
+}
+
+//-----------------------------------------------------------------------------
+// Whether the next numbers played are the expected ones
+//-----------------------------------------------------------------------------
+static int Plays (Playback *playback, const int *expected, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (Next (playback) != expected[i])
+			return 0;
+	return 1;
+}
+
+int main (void)
+{
+	static const int loop[] = { 2, 3, 4, 5, 2, 3, 4, 5, 2 };
+	static const int pingPong[] = { 2, 3, 4, 5, 4, 3, 2, 3, 4, 5, 4 };
+	static const int stop[] = { 2, 3, 4, 5, -1, -1 };
+	static const int seek[] = { 4, 5, 2 };
+	static const int fast[] = { 0, 3, 6, 9, 2, 5, 8 };
+	static const int slow[] = { 0, 0, 1, 1, 2, 2 };
+	Playback playback;
+	int i;
+
+	for (i = 0; i < NUM_VECTORS; i++)
+		vectors[i * PLAYBACK_NUM_ELEMENTS] = i;
+
+	PlaybackInit (&playback, vectors, NUM_VECTORS);
+	PlaybackSetRange (&playback, 2, 6);
+	CHECK(Plays (&playback, loop, sizeof(loop) / sizeof(loop[0])));
+
+	PlaybackSetMode (&playback, PLAYBACK_PING_PONG);
+	PlaybackSeek (&playback, 2);
+	CHECK(Plays (&playback, pingPong, sizeof(pingPong) / sizeof(pingPong[0])));
+
+	PlaybackSetMode (&playback, PLAYBACK_STOP);
+	PlaybackSeek (&playback, 2);
+	CHECK(Plays (&playback, stop, sizeof(stop) / sizeof(stop[0])));
+
+	// A seek goes on after a stop, and is kept within the range
+	PlaybackSetMode (&playback, PLAYBACK_LOOP);
+	PlaybackSeek (&playback, 4);
+	CHECK(Plays (&playback, seek, sizeof(seek) / sizeof(seek[0])));
+	PlaybackSeek (&playback, 100);
+	CHECK(playback.position == 5);
+	PlaybackSeek (&playback, 0);
+	CHECK(playback.position == 2);
+
+	// End 0 means all vectors, speeds skip or repeat vectors
+	PlaybackSetRange (&playback, 0, 0);
+	CHECK(playback.end == NUM_VECTORS);
+	PlaybackSeek (&playback, 0);
+	PlaybackSetSpeed (&playback, 3.0);
+	CHECK(Plays (&playback, fast, sizeof(fast) / sizeof(fast[0])));
+	PlaybackSeek (&playback, 0);
+	PlaybackSetSpeed (&playback, 0.5);
+	CHECK(Plays (&playback, slow, sizeof(slow) / sizeof(slow[0])));
+	PlaybackSetSpeed (&playback, 1000.0);
+	CHECK(playback.speed == PLAYBACK_MAX_SPEED);
+
+	// Nothing to play
+	PlaybackInit (&playback, vectors, 0);
+	CHECK(Next (&playback) == -1);
+	return CHECK_RESULT;
+}
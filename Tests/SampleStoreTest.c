@@ -0,0 +1,117 @@
+//==============================================================================
+// Title:		Unit test of the sample store.
+// Description:	Appends vectors across block boundaries in uneven pieces and
+//				checks stable vector pointers, the per-axis copy over block
+//				boundaries, and a read-only store attached to external data.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include "Check.h"
+#include "SampleStore.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define NUM_VECTORS		(2 * SAMPLE_STORE_BLOCK_VECTORS + 100)
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static double vectors[NUM_VECTORS * SAMPLE_STORE_NUM_ELEMENTS];
+static double axis[NUM_VECTORS];
+
+//-----------------------------------------------------------------------------
+// Value of an axis of vector n
+//-----------------------------------------------------------------------------
+static double Value (size_t n, int element)
+{
+	return n * 10.0 + element;
+}
+
+//-----------------------------------------------------------------------------
+// Copies starting just before a block boundary, spanning two boundaries, and
+// running past the end
+//-----------------------------------------------------------------------------
+static void CheckCopies (const SampleStore *store)
+{
+	size_t start;
+	size_t i;
+	int element;
+
+	for (element = 0; element < SAMPLE_STORE_NUM_ELEMENTS; element++)
+	{
+		start = SAMPLE_STORE_BLOCK_VECTORS - 3;
+		CHECK(SampleStoreCopyAxis (store, element, start, 6, axis) == 6);
+		for (i = 0; i < 6; i++)
+			CHECK(axis[i] == Value (start + i, element));
+
+		start = 5;
+		CHECK(SampleStoreCopyAxis (store, element, start, NUM_VECTORS - 10, axis) == NUM_VECTORS - 10);
+		for (i = 0; i < NUM_VECTORS - 10; i++)
+			CHECK(axis[i] == Value (start + i, element));
+
+		start = NUM_VECTORS - 4;
+		CHECK(SampleStoreCopyAxis (store, element, start, 100, axis) == 4);
+		CHECK(axis[3] == Value (NUM_VECTORS - 1, element));
+		CHECK(SampleStoreCopyAxis (store, element, NUM_VECTORS, 1, axis) == 0);
+	}
+}
+
+static void TestAppend (void)
+{
+	SampleStore store;
+	double *first;
+	size_t n;
+	size_t count;
+
+	SampleStoreInit (&store);
+	CHECK(SampleStoreAppend (&store, vectors, 1) == 0);
+	first = SampleStoreVector (&store, 0);
+	for (n = 1; n < NUM_VECTORS; n += count)
+	{
+		count = NUM_VECTORS - n < 1000 ? NUM_VECTORS - n : 1000;
+		CHECK(SampleStoreAppend (&store, vectors + n * SAMPLE_STORE_NUM_ELEMENTS, count) == 0);
+	}
+	CHECK(store.count == NUM_VECTORS);
+	CHECK(store.numBlocks == 3);
+
+	// Blocks never move, and vector pointers stay valid
+	CHECK(SampleStoreVector (&store, 0) == first);
+	for (n = 0; n < NUM_VECTORS; n++)
+		CHECK(SampleStoreVector (&store, n)[2] == Value (n, 2));
+	CheckCopies (&store);
+	SampleStoreFree (&store);
+	CHECK(store.count == 0 && store.blocks == NULL);
+}
+
+static void TestAttach (void)
+{
+	SampleStore store;
+
+	SampleStoreInit (&store);
+	CHECK(SampleStoreAttach (&store, vectors, NUM_VECTORS) == 0);
+	CHECK(store.count == NUM_VECTORS && store.external);
+	CHECK(SampleStoreVector (&store, NUM_VECTORS - 1) == vectors + (NUM_VECTORS - 1) * SAMPLE_STORE_NUM_ELEMENTS);
+	CheckCopies (&store);
+
+	// Read-only
+	CHECK(SampleStoreAppend (&store, vectors, 1) == -1);
+	SampleStoreFree (&store);
+	CHECK(vectors[0] == Value (0, 0));
+}
+
+int main (void)
+{
+	size_t n;
+	int element;
+
+	for (n = 0; n < NUM_VECTORS; n++)
+		for (element = 0; element < SAMPLE_STORE_NUM_ELEMENTS; element++)
+			vectors[n * SAMPLE_STORE_NUM_ELEMENTS + element] = Value (n, element);
+
+	TestAppend ();
+	TestAttach ();
+	return CHECK_RESULT;
+}
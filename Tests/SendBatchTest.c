@@ -0,0 +1,108 @@
+//==============================================================================
+// Title:		Unit test of the send batch.
+// Description:	Encodes into the batch, writes it in pieces limited by the
+//				room in the output queue, and checks that a stall is counted
+//				once however long it lasts, that its time adds up, and that
+//				clearing the batch keeps the totals.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "Check.h"
+#include "SendBatch.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define CAPACITY		16
+
+//-----------------------------------------------------------------------------
+// Append bytes first .. first + count - 1, as an encoder would
+//-----------------------------------------------------------------------------
+static void Encode (SendBatch *batch, unsigned char first, size_t count)
+{
+	unsigned char *tail = SendBatchTail (batch);
+	size_t i;
+
+	for (i = 0; i < count; i++)
+		tail[i] = (unsigned char)(first + i);
+	SendBatchCommit (batch, count);
+}
+
+static void TestWrite (void)
+{
+	SendBatch batch;
+	size_t i;
+
+	CHECK(SendBatchInit (&batch, CAPACITY) == 0);
+	CHECK(SendBatchRoom (&batch) == CAPACITY);
+	CHECK(SendBatchWritable (&batch, 100, 0.0) == 0);
+
+	Encode (&batch, 0, 10);
+	CHECK(SendBatchRoom (&batch) == CAPACITY - 10);
+
+	// Never more than the queue has room for, the rest moves to the head
+	CHECK(SendBatchWritable (&batch, 4, 0.1) == 4);
+	SendBatchConsume (&batch, 4);
+	CHECK(batch.length == 6);
+	for (i = 0; i < 6; i++)
+		CHECK(batch.bytes[i] == 4 + i);
+
+	Encode (&batch, 10, SendBatchRoom (&batch));
+	CHECK(SendBatchRoom (&batch) == 0);
+	CHECK(SendBatchWritable (&batch, 100, 0.2) == CAPACITY);
+	CHECK(batch.bytes[CAPACITY - 1] == 4 + CAPACITY - 1);
+
+	// Consuming more than waits empties the batch
+	SendBatchConsume (&batch, CAPACITY + 1);
+	CHECK(batch.length == 0);
+	CHECK(batch.stalls == 0 && batch.stalledTime == 0.0);
+	SendBatchFree (&batch);
+	CHECK(batch.bytes == NULL && batch.capacity == 0);
+}
+
+static void TestStalls (void)
+{
+	SendBatch batch;
+
+	CHECK(SendBatchInit (&batch, CAPACITY) == 0);
+
+	// No room and nothing waiting is no stall
+	CHECK(SendBatchWritable (&batch, 0, 1.0) == 0);
+	CHECK(batch.stalls == 0);
+
+	// A stall from 2.0 to 2.5 checked three times counts once
+	Encode (&batch, 0, 8);
+	CHECK(SendBatchWritable (&batch, 0, 2.0) == 0);
+	CHECK(SendBatchWritable (&batch, 0, 2.25) == 0);
+	CHECK(SendBatchWritable (&batch, 8, 2.5) == 8);
+	SendBatchConsume (&batch, 8);
+	CHECK(batch.stalls == 1);
+	CHECK_NEAR(batch.stalledTime, 0.5, 1e-12);
+
+	// The time between checks with room doesn't count
+	Encode (&batch, 0, 8);
+	CHECK(SendBatchWritable (&batch, 4, 3.0) == 4);
+	SendBatchConsume (&batch, 4);
+	CHECK(SendBatchWritable (&batch, 0, 4.0) == 0);
+	CHECK(SendBatchWritable (&batch, 0, 4.125) == 0);
+	CHECK(batch.stalls == 2);
+	CHECK_NEAR(batch.stalledTime, 0.625, 1e-12);
+
+	// Clearing drops the bytes and ends the stall, the totals carry on
+	SendBatchClear (&batch);
+	CHECK(batch.length == 0 && !batch.stalled);
+	CHECK(SendBatchWritable (&batch, 0, 10.0) == 0);
+	CHECK(batch.stalls == 2);
+	CHECK_NEAR(batch.stalledTime, 0.625, 1e-12);
+	SendBatchFree (&batch);
+}
+
+int main (void)
+{
+	TestWrite ();
+	TestStalls ();
+	return CHECK_RESULT;
+}
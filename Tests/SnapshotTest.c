@@ -0,0 +1,52 @@
+//==============================================================================
+// Title:		Unit test of the triple-buffer snapshot.
+// Description:	Checks on one thread that the reader always gets the latest
+//				publication, keeps its snapshot while nothing new arrives,
+//				and that the writer never fills the reader's slot.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include "Check.h"
+#include "Snapshot.h"
+
+static void Publish (Snapshot *snapshot, int value)
+{
+	*(int*)SnapshotBack (snapshot) = value;
+	SnapshotPublish (snapshot);
+}
+
+int main (void)
+{
+	Snapshot snapshot;
+	const int *latest;
+	int i;
+
+	CHECK(SnapshotInit (&snapshot, sizeof(int)) == 0);
+	CHECK(*(const int*)SnapshotLatest (&snapshot) == 0);	// Zeroed before the first publication
+
+	Publish (&snapshot, 1);
+	CHECK(*(const int*)SnapshotLatest (&snapshot) == 1);
+	CHECK(*(const int*)SnapshotLatest (&snapshot) == 1);	// Nothing new, the same again
+
+	// The reader skips what it missed
+	for (i = 2; i <= 10; i++)
+		Publish (&snapshot, i);
+	latest = (const int*)SnapshotLatest (&snapshot);
+	CHECK(*latest == 10);
+
+	// Publishing more never writes into the slot being read
+	for (i = 11; i <= 20; i++)
+	{
+		Publish (&snapshot, i);
+		CHECK(*latest == 10);
+		CHECK((const void*)SnapshotBack (&snapshot) != (const void*)latest);
+	}
+	CHECK(*(const int*)SnapshotLatest (&snapshot) == 20);
+
+	SnapshotClear (&snapshot);
+	CHECK(*(const int*)SnapshotLatest (&snapshot) == 0);
+	SnapshotFree (&snapshot);
+	return CHECK_RESULT;
+}
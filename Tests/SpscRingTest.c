@@ -0,0 +1,100 @@
+//==============================================================================
+// Title:		Unit test of the SPSC ring.
+// Description:	Passes numbered items through a small ring in uneven
+//				batches, copied and in place, so the counters wrap the ring
+//				many times and runs split at its end. A second part starts
+//				the free-running counters just below their wrap.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include "Check.h"
+#include "SpscRing.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define CAPACITY	8
+
+//-----------------------------------------------------------------------------
+// Write and read count items numbered from *next, in place every other round
+//-----------------------------------------------------------------------------
+static void Pass (SpscRing *ring, unsigned int *nextWritten, unsigned int *nextRead, unsigned int count, int inPlace)
+{
+	unsigned int items[CAPACITY];
+	unsigned int *slots;
+	const unsigned int *run;
+	unsigned int numItems;
+	unsigned int i;
+
+	if (inPlace)
+	{
+		// A run ends at the end of the ring, the rest follows in a second run
+		while (count > 0)
+		{
+			slots = (unsigned int*)SpscRingReserve (ring, &numItems);
+			CHECK(slots != NULL && numItems > 0);
+			if (!slots || numItems == 0)
+				return;
+			if (numItems > count)
+				numItems = count;
+			for (i = 0; i < numItems; i++)
+				slots[i] = (*nextWritten)++;
+			SpscRingPublish (ring, numItems);
+			count -= numItems;
+		}
+		while ((run = (const unsigned int*)SpscRingPeek (ring, &numItems)) && numItems > 0)
+		{
+			for (i = 0; i < numItems; i++)
+				CHECK(run[i] == (*nextRead)++);
+			SpscRingConsume (ring, numItems);
+		}
+	}
+	else
+	{
+		for (i = 0; i < count; i++)
+			items[i] = (*nextWritten)++;
+		CHECK(SpscRingWrite (ring, items, count) == count);
+		numItems = SpscRingRead (ring, items, CAPACITY);
+		CHECK(numItems == count);
+		for (i = 0; i < numItems; i++)
+			CHECK(items[i] == (*nextRead)++);
+	}
+}
+
+static void TestWrap (unsigned int start)
+{
+	SpscRing ring;
+	unsigned int items[CAPACITY + 1];
+	unsigned int nextWritten = 0;
+	unsigned int nextRead = 0;
+	unsigned int round;
+
+	CHECK(SpscRingInit (&ring, CAPACITY, sizeof(unsigned int)) == 0);
+	ring.head = ring.tail = ring.tailSeen = ring.headSeen = start;
+
+	for (round = 0; round < 100; round++)
+		Pass (&ring, &nextWritten, &nextRead, 1 + round % CAPACITY, round & 1);
+	CHECK(nextRead == nextWritten);
+
+	// A full ring takes no more, an empty one gives nothing
+	for (round = 0; round <= CAPACITY; round++)
+		items[round] = round;
+	CHECK(SpscRingWrite (&ring, items, CAPACITY + 1) == CAPACITY);
+	CHECK(SpscRingWrite (&ring, items, 1) == 0);
+	CHECK(SpscRingRead (&ring, items, CAPACITY + 1) == CAPACITY);
+	CHECK(items[CAPACITY - 1] == CAPACITY - 1);
+	CHECK(SpscRingRead (&ring, items, 1) == 0);
+	SpscRingFree (&ring);
+}
+
+int main (void)
+{
+	SpscRing ring;
+
+	CHECK(SpscRingInit (&ring, 6, sizeof(int)) < 0); // Not a power of two
+	TestWrap (0);
+	TestWrap (0xFFFFFFFFu - 20);
+	return CHECK_RESULT;
+}
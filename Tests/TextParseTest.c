@@ -0,0 +1,92 @@
+//==============================================================================
+// Title:		Unit test of the bounded text parsers.
+// Description:	Checks numbers in their accepted forms, that parsing stops
+//				at the end pointer and at malformed input without reading
+//				past it, and line skipping with and without a last newline.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "Check.h"
+#include "TextParse.h"
+
+//-----------------------------------------------------------------------------
+// Parse text as a double. Returns the characters consumed, -1 for none.
+//-----------------------------------------------------------------------------
+static int Parse (const char *text, double *value)
+{
+	const char *end = ParseDouble (text, text + strlen (text), value);
+
+	return end ? (int)(end - text) : -1;
+}
+
+static void TestNumbers (void)
+{
+	double value = 0;
+
+	CHECK(Parse ("20527.13", &value) == 8 && value == 20527.13);
+	CHECK(Parse ("-0.5\t1", &value) == 4 && value == -0.5);
+	CHECK(Parse ("+42", &value) == 3 && value == 42.0);
+	CHECK(Parse (".25", &value) == 3 && value == 0.25);
+	CHECK(Parse ("7.", &value) == 2 && value == 7.0);
+	CHECK(Parse ("1.5e3", &value) == 5 && value == 1500.0);
+	CHECK(Parse ("2E-2", &value) == 4 && value == 0.02);
+	CHECK(Parse ("0.1", &value) == 3 && value == 0.1);
+	CHECK(Parse ("123456789012345678901234", &value) == 24);
+	CHECK_NEAR(value, 1.23456789012345678901234e23, 1e9);
+	CHECK(Parse ("1e400", &value) == 5 && isinf(value));
+}
+
+static void TestMalformed (void)
+{
+	const char *text = "12345";
+	unsigned int count = 0;
+	double value = 99;
+
+	// No number at all: nothing consumed, the value untouched
+	CHECK(Parse ("", &value) == -1);
+	CHECK(Parse ("x1", &value) == -1);
+	CHECK(Parse ("-", &value) == -1);
+	CHECK(Parse (".", &value) == -1);
+	CHECK(Parse ("+.e5", &value) == -1);
+	CHECK(Parse ("nan", &value) == -1);
+	CHECK(value == 99);
+
+	// A number followed by junk stops before it, an incomplete exponent is left alone
+	CHECK(Parse ("3.5abc", &value) == 3 && value == 3.5);
+	CHECK(Parse ("4e", &value) == 1 && value == 4.0);
+	CHECK(Parse ("4e+", &value) == 1 && value == 4.0);
+	CHECK(Parse ("1,5", &value) == 1 && value == 1.0);
+
+	// The end pointer bounds the number, also inside the text
+	CHECK(ParseDouble (text, text + 3, &value) == text + 3 && value == 123.0);
+	CHECK(ParseUnsigned (text, text + 2, &count) == text + 2 && count == 12);
+	CHECK(ParseUnsigned (text, text, &count) == NULL);
+	CHECK(ParseUnsigned ("-1", "-1" + 2, &count) == NULL);
+}
+
+static void TestLines (void)
+{
+	const char *text = "a b\r\n\n  \tlast";
+	const char *end = text + strlen (text);
+	const char *cursor;
+
+	cursor = SkipLine (text, end);
+	CHECK(cursor == text + 5);
+	cursor = SkipLine (cursor, end);
+	CHECK(cursor == text + 6);
+	CHECK(SkipBlanks (cursor, end) == text + 9);
+	CHECK(SkipLine (cursor, end) == end);	// Last line without a newline
+	CHECK(SkipLine (end, end) == end);
+	CHECK(SkipBlanks (end, end) == end);
+}
+
+int main (void)
+{
+	TestNumbers ();
+	TestMalformed ();
+	TestLines ();
+	return CHECK_RESULT;
+}
@@ -0,0 +1,87 @@
+//==============================================================================
+// Title:		Unit test of the decimated field trajectory.
+// Description:	Appends vectors in uneven pieces and checks the averaged
+//				points, oldest first, before and after the ring wraps.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include "Check.h"
+#include "Trajectory.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define CAPACITY		20
+#define DECIMATION		5 		// 10 s at 10 Hz over CAPACITY points
+#define MAX_VECTORS		(DECIMATION * 27 + 3)
+
+//-----------------------------------------------------------------------------
+// Global variables
+//-----------------------------------------------------------------------------
+static Trajectory trajectory;
+static double vectors[MAX_VECTORS * TRAJECTORY_NUM_ELEMENTS];
+
+//-----------------------------------------------------------------------------
+// Append vectors first .. last - 1 in pieces of 7
+//-----------------------------------------------------------------------------
+static void Append (size_t first, size_t last)
+{
+	size_t count;
+
+	for (; first < last; first += count)
+	{
+		count = last - first < 7 ? last - first : 7;
+		TrajectoryAppend (&trajectory, vectors + first * TRAJECTORY_NUM_ELEMENTS, count);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Point k averages vectors 5k .. 5k + 4, so its x is 5k + 2
+//-----------------------------------------------------------------------------
+static void CheckPoints (size_t firstPoint, size_t numPoints)
+{
+	double dest[TRAJECTORY_MAX_POINTS];
+	size_t i;
+	int axis;
+
+	for (axis = 0; axis < TRAJECTORY_NUM_ELEMENTS; axis++)
+	{
+		CHECK(TrajectoryCopyAxis (&trajectory, axis, dest) == numPoints);
+		for (i = 0; i < numPoints; i++)
+			CHECK(dest[i] == (axis == 1 ? 2.0 : axis == 2 ? -1.0 : 1.0) * (DECIMATION * (firstPoint + i) + 2));
+	}
+}
+
+int main (void)
+{
+	size_t n;
+
+	for (n = 0; n < MAX_VECTORS; n++)
+	{
+		vectors[n * TRAJECTORY_NUM_ELEMENTS] = (double)n;
+		vectors[n * TRAJECTORY_NUM_ELEMENTS + 1] = 2.0 * n;
+		vectors[n * TRAJECTORY_NUM_ELEMENTS + 2] = -(double)n;
+	}
+
+	TrajectoryReset (&trajectory, 10.0, 10.0, CAPACITY);
+	CHECK(trajectory.decimation == DECIMATION);
+	CheckPoints (0, 0);
+
+	// Ten points and an open one, not wrapped yet
+	Append (0, DECIMATION * 10 + 3);
+	CHECK(trajectory.total == 10);
+	CheckPoints (0, 10);
+
+	// 27 points in all: the ring keeps the last 20
+	Append (DECIMATION * 10 + 3, DECIMATION * 27 + 3);
+	CHECK(trajectory.total == 27);
+	CheckPoints (7, CAPACITY);
+
+	// A reset empties it, a capacity past the maximum is clamped
+	TrajectoryReset (&trajectory, 10.0, 10.0, TRAJECTORY_MAX_POINTS + 1);
+	CHECK(trajectory.capacity == TRAJECTORY_MAX_POINTS);
+	CHECK(trajectory.count == 0 && trajectory.total == 0);
+	return CHECK_RESULT;
+}
@@ -0,0 +1,115 @@
+//==============================================================================
+// Title:		Unit test of the vector file loader.
+// Description:	Loads plain and timed text files with malformed rows, which
+//				are skipped, a binary log, and rejects files without vectors.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <string.h>
+#include "Check.h"
+#include "VectorFile.h"
+
+//-----------------------------------------------------------------------------
+// Defines
+//-----------------------------------------------------------------------------
+#define TEST_PATHNAME	"VectorFileTest.tmp"
+
+static int WriteFile (const char *contents, size_t size)
+{
+	FILE *file = fopen (TEST_PATHNAME, "wb");
+
+	if (!file)
+		return -1;
+	if (fwrite(contents, 1, size, file) != size)
+		size = 0;
+	return fclose (file) == 0 && size ? 0 : -1;
+}
+
+static void TestText (void)
+{
+	static const char text[] =
+		"MAGNETIC FIELD DATA\n"
+		"1 2 3\n"
+		"4 5\n"								// Too few values
+		"\t-1.5\t2e1   +3 trailing text\r\n"
+		"x 1 2 3\n"
+		"\n"
+		"7 8 9";							// No newline at the end
+	VectorFile data;
+
+	CHECK(WriteFile (text, strlen (text)) == 0);
+	CHECK(VectorFileOpen (&data, TEST_PATHNAME) == 0);
+	CHECK(data.format == VECTOR_FILE_TEXT);
+	CHECK(data.numVectors == 3);
+	if (data.numVectors == 3)
+	{
+		CHECK(data.vectors[0] == 1 && data.vectors[2] == 3);
+		CHECK(data.vectors[3] == -1.5 && data.vectors[4] == 20 && data.vectors[5] == 3);
+		CHECK(data.vectors[6] == 7 && data.vectors[8] == 9);
+	}
+	CHECK(data.fs == 0);
+	VectorFileClose (&data);
+}
+
+static void TestTextLog (void)
+{
+	static const char text[] =
+		"Time \t\t x \t\t y\t\t z \n"
+		"12:00:00 \t 1.00 \t 2.00 \t 3.00\n"
+		"12:00 \t 9.00 \t 9.00 \t 9.00\n"	// Broken time
+		"12:00:01 \t 4.00 \t 5.00 \t 6.00\n";
+	VectorFile data;
+
+	CHECK(WriteFile (text, strlen (text)) == 0);
+	CHECK(VectorFileOpen (&data, TEST_PATHNAME) == 0);
+	CHECK(data.format == VECTOR_FILE_TEXT_LOG);
+	CHECK(data.numVectors == 2);
+	if (data.numVectors == 2)
+		CHECK(data.vectors[0] == 1 && data.vectors[5] == 6);
+	VectorFileClose (&data);
+}
+
+static void TestBinaryLog (void)
+{
+	static const double vectors[2][VECTOR_FILE_NUM_ELEMENTS] = { { 1, 2, 3 }, { 4, 5, 6 } };
+	FILE *file = fopen (TEST_PATHNAME, "wb");
+	VectorFile data;
+
+	CHECK(file != NULL);
+	if (!file)
+		return;
+	CHECK(MagnoLogWriteHeader (file, 250.0, 0.0) == 0);
+	CHECK(fwrite(vectors, sizeof(vectors), 1, file) == 1);
+	fclose (file);
+
+	CHECK(VectorFileOpen (&data, TEST_PATHNAME) == 0);
+	CHECK(data.format == VECTOR_FILE_BINARY_LOG);
+	CHECK(data.numVectors == 2 && data.fs == 250.0);
+	if (data.numVectors == 2)
+		CHECK(memcmp(data.vectors, vectors, sizeof(vectors)) == 0);
+	VectorFileClose (&data);
+}
+
+static void TestRejected (void)
+{
+	static const char text[] = "no\nvectors 1 2\n";
+	VectorFile data;
+
+	CHECK(WriteFile (text, strlen (text)) == 0);
+	CHECK(VectorFileOpen (&data, TEST_PATHNAME) == MAGNO_LOG_ERROR_FORMAT);
+	CHECK(data.vectors == NULL && data.numVectors == 0);
+	CHECK(VectorFileOpen (&data, "VectorFileTest.missing") == MAGNO_LOG_ERROR_FILE);
+}
+
+int main (void)
+{
+	TestText ();
+	TestTextLog ();
+	TestBinaryLog ();
+	TestRejected ();
+	remove (TEST_PATHNAME);
+	return CHECK_RESULT;
+}
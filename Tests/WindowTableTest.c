@@ -0,0 +1,94 @@
+//==============================================================================
+// Title:		Unit test of the window coefficient cache.
+// Description:	Checks known window sums, that a cached table is handed out
+//				again without recomputing it, and that a full cache replaces
+//				its least recently used table.
+//==============================================================================
+
+//-----------------------------------------------------------------------------
+// Include files
+//-----------------------------------------------------------------------------
+#include <string.h>
+#include "Check.h"
+#include "WindowTable.h"
+
+//-----------------------------------------------------------------------------
+// Whether the cache holds a table of a window type and length
+//-----------------------------------------------------------------------------
+static int Cached (const WindowCache *cache, WindowType type, size_t length)
+{
+	int i;
+
+	for (i = 0; i < WINDOW_CACHE_SIZE; i++)
+		if (cache->tables[i].coefficients && cache->tables[i].type == type && cache->tables[i].length == length)
+			return 1;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// A periodic Hann window of N sums to N / 2, its squares to 3N / 8
+//-----------------------------------------------------------------------------
+static void TestCoefficients (void)
+{
+	const WindowTable *table;
+	WindowCache cache;
+
+	memset(&cache, 0, sizeof(cache));
+	table = WindowCacheGet (&cache, WINDOW_HANN, 64);
+	CHECK(table != NULL);
+	if (table)
+	{
+		CHECK(table->length == 64 && table->type == WINDOW_HANN);
+		CHECK_NEAR(table->coefficients[0], 0.0, 1e-12);
+		CHECK_NEAR(table->coefficients[32], 1.0, 1e-12);
+		CHECK_NEAR(table->sum, 32.0, 1e-9);
+		CHECK_NEAR(table->sumOfSquares, 24.0, 1e-9);
+	}
+	table = WindowCacheGet (&cache, WINDOW_HAMMING, 64);
+	CHECK(table && fabs(table->sum - 0.54 * 64) < 1e-9);
+	WindowCacheFree (&cache);
+}
+
+//-----------------------------------------------------------------------------
+// Fill the cache, use the oldest table again, then add one more: the table
+// used longest ago is the one replaced
+//-----------------------------------------------------------------------------
+static void TestReplacement (void)
+{
+	const WindowTable *tables[WINDOW_CACHE_SIZE];
+	const WindowTable *table;
+	WindowCache cache;
+	int i;
+
+	memset(&cache, 0, sizeof(cache));
+	for (i = 0; i < WINDOW_CACHE_SIZE; i++)
+		tables[i] = WindowCacheGet (&cache, WINDOW_BLACKMAN_HARRIS, 16 + i);
+	for (i = 0; i < WINDOW_CACHE_SIZE; i++)
+		CHECK(Cached (&cache, WINDOW_BLACKMAN_HARRIS, 16 + i));
+
+	// A hit returns the same table
+	CHECK(WindowCacheGet (&cache, WINDOW_BLACKMAN_HARRIS, 16) == tables[0]);
+
+	// Length 17 is now the least recently used
+	table = WindowCacheGet (&cache, WINDOW_FLAT_TOP, 100);
+	CHECK(table == tables[1]);
+	CHECK(!Cached (&cache, WINDOW_BLACKMAN_HARRIS, 17));
+	CHECK(Cached (&cache, WINDOW_BLACKMAN_HARRIS, 16));
+	CHECK(Cached (&cache, WINDOW_FLAT_TOP, 100));
+
+	// Then length 18, while the type alone doesn't make a hit
+	table = WindowCacheGet (&cache, WINDOW_HANN, 16);
+	CHECK(table == tables[2]);
+	CHECK(!Cached (&cache, WINDOW_BLACKMAN_HARRIS, 18));
+	CHECK(Cached (&cache, WINDOW_BLACKMAN_HARRIS, 16) && Cached (&cache, WINDOW_HANN, 16));
+
+	WindowCacheFree (&cache);
+	CHECK(!Cached (&cache, WINDOW_HANN, 16));
+}
+
+int main (void)
+{
+	TestCoefficients ();
+	TestReplacement ();
+	return CHECK_RESULT;
+}
@@ -7,34 +7,139 @@
 //-----------------------------------------------------------------------------
 // Include files
 //-----------------------------------------------------------------------------
+#include <windows.h>
 #include <utility.h>
 #include <rs232.h>
 #include <ansi_c.h>
+#include <stdint.h>
 #include <cvirte.h>
 #include <userint.h>
 #include "Transmitter.h"
 #include "ComConfigDLL.h"
+#include "MagnoFrame.h"
+#include "Pacer.h"
+#include "VectorFile.h"
+#include "Playback.h"
+#include "FieldGenerator.h"
+#include "MagnoAtomic.h"
+#include "Snapshot.h"
+#include "SendBatch.h"
 //-----------------------------------------------------------------------------
 // Defines
 //-----------------------------------------------------------------------------
-#define LEN 90000
-#define TIME_INTERVAL 0.02
+#define DATA_PATHNAME			"Data.txt" 	// Vectors sent when no file is named on the command line
+#define MAX_VECTORS_PER_WRITE	256 	// Vectors framed at a time
+#define DEFAULT_OUTPUT_QUEUE	512 	// Output queue assumed when the driver doesn't report its size
+#define MAX_WAIT				0.05 	// Longest sleep, keeps quitting responsive
+#define UI_UPDATE_INTERVAL		0.1 	// Seconds between indicator updates
+#define MAX_BURST				1000
+#define DEFAULT_BLOCK_SIZE		16 		// Vectors per block frame
+
+#define SOURCE_FILE				0 		// Vectors played from the data file
+#define SOURCE_GENERATOR		1 		// Vectors synthesized by the field generator
+//-----------------------------------------------------------------------------
+// Types
+//-----------------------------------------------------------------------------
+// Control values the send thread follows, read on the UI thread
+typedef struct
+{
+	double rate;				// Vectors per second, within the link's limit
+	int burst;
+	int encoding;
+	int blockSize;
+	int source;
+	unsigned int start;			// Playback range, mode and speed
+	unsigned int end;
+	int mode;
+	double speed;
+	unsigned int seekCount;		// Seeks requested so far, the send thread seeks when it changes
+	unsigned int seekPosition;
+	GeneratorModel model;
+} SendSettings;
+
+// What the send thread reports, sampled by the UI timer
+typedef struct
+{
+	AtomicIndex vectorsSent;	// Wraps, only differences are shown
+	AtomicIndex bytesWritten;	// By the last write
+	AtomicIndex checksum;		// Last byte of the last write
+	AtomicIndex slips;
+	AtomicIndex position;		// Playback position
+	AtomicIndex stalls;			// Writes held back by flow control or a full queue
+	AtomicIndex stalledTime;	// Milliseconds spent stalled, wraps
+} SendCounters;
+
+// Line settings, flow control and output queue of the configured port, read
+// back from the system since ComConfig.dll only exports the port number
+typedef struct
+{
+	intptr_t handle;			// System handle, for the flow control state
+	double baudrate;
+	int bitsPerByte;			// Start, data, parity and stop bits
+	int ctsFlow;				// Output held while CTS is off
+	int xonFlow;				// Output held after an XOFF from the receiver
+	size_t outputQueue;			// Bytes of the driver's output queue
+} PortSettings;
 //-----------------------------------------------------------------------------
 // Prototypes
 //-----------------------------------------------------------------------------
 void CVICALLBACK ComCallback (int portNumber, int eventMask, void *callbackData);
 static int CVICALLBACK ThreadSendData (void *functionData);
 unsigned int Connected(int portNumber);
+unsigned int ClearToSend(int portNumber);
+size_t OutputQueueSize();
+size_t OutputQueueRoom(int portNumber);
+int ReadPortSettings(int portNumber);
+void CreateControls();
+double LinkRateLimit(int encoding, int blockSize);
+unsigned int PacedBurst(int burst, int blockSize);
+void SendData();
+void ApplySettings(const SendSettings *settings, Pacer *pacer, double now);
+void PublishSettings();
+void ReadGeneratorControls(GeneratorModel *model);
+void ShowCounters();
+int NewGeneratorControl(const char *label, int top, int left, double value);
+static int CVICALLBACK SeekCallback (int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
+static int CVICALLBACK UpdateTimerCallback (int panel, int control, int event, void *callbackData, int eventData1, int eventData2);
 //-----------------------------------------------------------------------------
 // Global variables
 //-----------------------------------------------------------------------------
 int panelHandle;
 CmtThreadFunctionID threadFunctionId;
-CmtThreadLockHandle lock;
 
-double dataArray[LEN];
+VectorFile data; // Vectors to send
+Playback playback; // Position in data, owned by the send thread
+FieldGenerator generator; // Synthetic field, owned by the send thread
+Snapshot settingsSnapshot; // SendSettings, from the UI thread to the send thread
+SendCounters counters; // From the send thread to the UI timer
+SendBatch batch; // Frames waiting for room in the output queue, owned by the send thread
+PortSettings port;
+AtomicIndex breakReceived; // Set by the break callback, starts sending
+unsigned int seekCount; // Seeks requested, UI thread only
 int volatile quitting;
-double time_interval;
+int updateTimer;
+int burstControl;
+int rateIndicator;
+int slipsIndicator;
+int stallsIndicator;
+int stalledIndicator;
+int encodingControl;
+int blockSizeControl;
+int playbackModeControl;
+int speedControl;
+int startControl;
+int endControl;
+int seekControl;
+int positionIndicator;
+int sourceControl;
+int toneFrequencyControl;
+int toneAmplitudeControl;
+int mainsControl;
+int mainsAmplitudeControl;
+int whiteNoiseControl;
+int pinkNoiseControl;
+int stepControl;
+int stepIntervalControl;
 
 //-----------------------------------------------------------------------------
 // Program entry-point
@@ -46,27 +151,45 @@ int main (int argc, char *argv[])
 	if ((panelHandle = LoadPanel (0, "Transmitter.uir", PANEL)) < 0)
 		return -1;
 
-	// open file
-	FILE *fp;
-	fp = fopen ("Data.txt", "r");
+	// Load the vectors to send: plain text, a receiver's text log or a binary log
+	if (VectorFileOpen (&data, argc > 1 ? argv[1] : DATA_PATHNAME) < 0)
+	{
+		MessagePopup ("Error", "Failed to load the data file.\n");
+		DiscardPanel (panelHandle);
+		return -1;
+	}
+
+	// Settings handed from the UI thread to the send thread
+	if (SnapshotInit (&settingsSnapshot, sizeof(SendSettings)) < 0)
+	{
+		MessagePopup ("Error", "Out of memory for the settings.\n");
+		VectorFileClose (&data);
+		DiscardPanel (panelHandle);
+		return -1;
+	}
 
-	// read data from file
-	for (int i = 0; i < LEN; i++)
-		fscanf(fp, "%lf", dataArray + i);
+	PlaybackInit (&playback, data.vectors, data.numVectors);
+	CreateControls();
 
-	// close file
-	fclose(fp);
+	// Send a binary log at the rate it was recorded at
+	if (data.fs > 0)
+		SetCtrlVal (panelHandle, PANEL_SR, data.fs);
 
 	DisplayPanel (panelHandle);
 	RunUserInterface ();
 	CloseCVIRTE ();
 	DiscardPanel (panelHandle);
+	SnapshotFree (&settingsSnapshot);
+	SendBatchFree (&batch);
+	VectorFileClose (&data);
 	return 0;
 }
 
 int CVICALLBACK ConfigCallBack (int panel, int control, int event,
 								void *callbackData, int eventData1, int eventData2)
 {
+	size_t capacity;
+
 	switch (event)
 	{
 		case EVENT_COMMIT:
@@ -76,74 +199,282 @@ int CVICALLBACK ConfigCallBack (int panel, int control, int event,
 			if(!comport || RS232Error)
 				return 0; // Configuration wasn't performed  
 
+			// Line settings the rate is limited by
+			if (ReadPortSettings (comport) < 0)
+			{
+				MessagePopup ("Error", "Failed to read the port settings.\n");
+				return 0;
+			}
+
+			// Batch frames up to the output queue's size, at least a full write of vectors
+			capacity = OutputQueueSize();
+			if (capacity < MAX_VECTORS_PER_WRITE * FRAME_MAX_VECTOR_COST)
+				capacity = MAX_VECTORS_PER_WRITE * FRAME_MAX_VECTOR_COST;
+			if (SendBatchInit (&batch, capacity) < 0)
+			{
+				MessagePopup ("Error", "Out of memory for the send batch.\n");
+				return 0;
+			}
+
 			// Disable the Configure button
 			SetCtrlAttribute (panelHandle, PANEL_COM_CONFIG, ATTR_DIMMED, 1);
+			// Hand the send thread the controls' values before it can start
+			PublishSettings();
+			// Install the communication callback for detecting a break signal
+			InstallComCallback (comport, LWRS_BREAK , 0, 0 , ComCallback, 0);
 			// Schedule the thread function to send data
 			CmtScheduleThreadPoolFunction(DEFAULT_THREAD_POOL_HANDLE, ThreadSendData, 0, &threadFunctionId);
-			// Create a new lock for synchronization
-			CmtNewLock (NULL, OPT_TL_PROCESS_EVENTS_WHILE_WAITING, &lock);
+			// Follow the controls and show what is sent from here on
+			SetCtrlAttribute (panelHandle, updateTimer, ATTR_ENABLED, 1);
 			break;
 	}
 	return 0;
 }
 
+//-----------------------------------------------------------------------------
+// Send thread: sends from every break of the receiver until it disconnects
+//-----------------------------------------------------------------------------
 static int CVICALLBACK ThreadSendData (void *functionData)
 {
-	// Install the communication callback for detecting a break signal
-	InstallComCallback (comport, LWRS_BREAK , 0, 0 , ComCallback, 0);
+	while (!quitting)
+	{
+		if (AtomicExchange (&breakReceived, 0))
+			SendData();
+		else
+			Delay (MAX_WAIT);
+	}
 	return 0;
 }
 
+//-----------------------------------------------------------------------------
+// The receiver asks for data with a break, the send thread starts sending
+//-----------------------------------------------------------------------------
 void CVICALLBACK ComCallback (int portNo,int eventMask,void *callbackData)
 {
-	// Prepare packet for transmission
-	int i;
-	int numElements = 3;
-	int dataSize = sizeof(double) * numElements;
-	int packetSize = dataSize + 1;  // Include space for the checksum byte
+	AtomicStore (&breakReceived, 1);
+}
+
+//-----------------------------------------------------------------------------
+// Paced send loop on the send thread. It never touches the user interface:
+// it follows the settings the UI timer publishes and reports through atomic
+// counters, so a busy or dragged window cannot delay a write.
+//-----------------------------------------------------------------------------
+void SendData()
+{
+	static FrameSample samples[MAX_VECTORS_PER_WRITE];
+	static double generated[MAX_VECTORS_PER_WRITE * FRAME_NUM_ELEMENTS];
+	const SendSettings *settings;
+	const double *vector;
+	Pacer pacer;
+	double now;
+	double wait;
+	double drainWait;
+	unsigned int maxVectors;
+	unsigned int numVectors;
+	unsigned int numInFrame;
+	unsigned int sequence;
+	unsigned int i;
+	size_t numBytes;
 	int numBytesSent;
-	static int shift = 0;
-	char packet[packetSize];
-	char checksum;
+
+	// Pace to the requested rate, which the UI thread keeps within the baud rate
+	settings = SnapshotLatest (&settingsSnapshot);
+	now = Timer();
+	GeneratorInit (&generator, &settings->model, settings->rate);
+	PacerInit (&pacer, settings->rate, PacedBurst (settings->burst, settings->blockSize), now);
+	SendBatchClear (&batch);
+
+	// Number every session from 0, so its first frame is an anchor with the full fields
+	sequence = 0;
+
+	// With bytes waiting, look again when half the output queue has gone out
+	drainWait = OutputQueueSize() * port.bitsPerByte / (2.0 * port.baudrate);
+	if (drainWait > MAX_WAIT)
+		drainWait = MAX_WAIT;
 
 	// Send data
 	while(!quitting && Connected(comport))
 	{
-		// Lock protects from quitting the program while loop is running
-		CmtGetLock (lock);
-
-		// Copy double values to packet buffer
-		memcpy(packet, dataArray + shift, dataSize);
-
-		// Calculate checksum
-		for (i = 0, checksum = 0; i < dataSize; i++)
-			checksum ^= packet[i]; // XOR operation
-
-		SetCtrlVal(panelHandle, PANEL_CHECKSUM, checksum);
-
-		// Add checksum to the packet
-		packet[dataSize] = checksum;
-
-		// Send the packet over the communication channel
-		numBytesSent = ComWrt(comport, packet, packetSize);
-		
-		// Update shift for the next packet
-		shift += numElements;
-
-		// Update UI elements
-		SetCtrlVal(panelHandle, PANEL_NUM, numBytesSent);
-		SetCtrlVal(panelHandle, PANEL_OUTPUT_QUE, GetOutQLen(comport));
-
-		// LED blink to indicate data sent
-		SetCtrlVal (panelHandle, PANEL_LED, 1);
-		Delay(TIME_INTERVAL);
-		SetCtrlVal (panelHandle, PANEL_LED, 0);
-		Delay(TIME_INTERVAL);
-	    ProcessSystemEvents ();
-		
-		CmtReleaseLock (lock);
+		// Follow the latest control values
+		now = Timer();
+		settings = SnapshotLatest (&settingsSnapshot);
+		ApplySettings (settings, &pacer, now);
+
+		// Frame every vector due by now that the batch has room for. While the link is
+		// held back the batch stays full, the vectors fall behind and the pacer restarts.
+		do
+		{
+			maxVectors = (unsigned int)(SendBatchRoom (&batch) / FRAME_MAX_VECTOR_COST);
+			if (maxVectors > MAX_VECTORS_PER_WRITE)
+				maxVectors = MAX_VECTORS_PER_WRITE;
+			numVectors = PacerDue (&pacer, now, maxVectors);
+			if (settings->source == SOURCE_GENERATOR)
+				GeneratorFill (&generator, generated, numVectors);
+			for (i = 0; i < numVectors; i++)
+			{
+				// Next synthesized vector, or of the playback range, none once stopped at its end
+				if (settings->source == SOURCE_GENERATOR)
+					vector = generated + i * FRAME_NUM_ELEMENTS;
+				else if (!(vector = PlaybackNext (&playback)))
+					break;
+
+				// Number and timestamp every vector so the receiver sees losses and the real rate
+				samples[i].sequence = sequence++;
+				samples[i].timestamp = (unsigned long long)(PacerTime (&pacer, pacer.released - numVectors + i) / FRAME_TIMESTAMP_UNIT);
+				memcpy(samples[i].vector, vector, sizeof(samples[i].vector));
+			}
+			numVectors = i;
+
+			// Wrap them in block frames under one CRC, or one frame with a check byte each
+			numBytes = 0;
+			for (i = 0; i < numVectors; i += numInFrame)
+			{
+				numInFrame = numVectors - i < (unsigned int)settings->blockSize ? numVectors - i : (unsigned int)settings->blockSize;
+				if (settings->blockSize > 1)
+					numBytes += FrameEncodeBlock(samples + i, numInFrame, settings->encoding, SendBatchTail (&batch) + numBytes);
+				else
+					numBytes += FrameEncode(samples + i, settings->encoding, SendBatchTail (&batch) + numBytes);
+			}
+			if (numBytes)
+			{
+				SendBatchCommit (&batch, numBytes);
+				AtomicStore (&counters.checksum, batch.bytes[batch.length - 1]);
+				AtomicStore (&counters.vectorsSent, AtomicLoad (&counters.vectorsSent) + numVectors);
+			}
+		} while (numVectors && numVectors == maxVectors);
+
+		// Write as much of the batch as the output queue takes, nothing while CTS is off
+		numBytes = SendBatchWritable (&batch, ClearToSend(comport) ? OutputQueueRoom(comport) : 0, now);
+		if (numBytes)
+		{
+			numBytesSent = ComWrt(comport, (char *)batch.bytes, (int)numBytes);
+			if (numBytesSent > 0)
+				SendBatchConsume (&batch, (size_t)numBytesSent);
+			AtomicStore (&counters.bytesWritten, numBytesSent);
+		}
+		AtomicStore (&counters.slips, pacer.slips);
+		AtomicStore (&counters.position, playback.position);
+		AtomicStore (&counters.stalls, batch.stalls);
+		AtomicStore (&counters.stalledTime, (unsigned long long)(batch.stalledTime * 1000));
+
+		// Sleep until the next frame is due, or until the queue has room for what waits
+		if (batch.length)
+			wait = drainWait;
+		else
+			wait = PacerNextDeadline (&pacer, now) - Timer();
+		if (wait > MAX_WAIT)
+			wait = MAX_WAIT;
+		if (wait > 0)
+			Delay(wait);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Follow the rate, burst size, playback and generator settings. Called from
+// the send thread, which owns the pacer, the playback and the generator.
+//-----------------------------------------------------------------------------
+void ApplySettings(const SendSettings *settings, Pacer *pacer, double now)
+{
+	static unsigned int seeksDone = 0;
+	unsigned int burst = PacedBurst (settings->burst, settings->blockSize);
+
+	if (settings->rate != pacer->rate || burst != pacer->burst)
+		PacerSetRate (pacer, settings->rate, burst, now);
+
+	if (settings->start != playback.start || settings->end != playback.end)
+		PlaybackSetRange (&playback, settings->start, settings->end);
+	if (settings->mode != (int)playback.mode)
+		PlaybackSetMode (&playback, (PlaybackMode)settings->mode);
+	PlaybackSetSpeed (&playback, settings->speed);
+	if (settings->seekCount != seeksDone)
+	{
+		seeksDone = settings->seekCount;
+		PlaybackSeek (&playback, settings->seekPosition);
 	}
-	return;
+
+	// Rebuilding the oscillator tables only pays when something changed, and not while paused
+	if (settings->rate > 0 && (settings->rate != generator.fs || memcmp(&settings->model, &generator.model, sizeof(generator.model)) != 0))
+		GeneratorSetModel (&generator, &settings->model, settings->rate);
+}
+
+//-----------------------------------------------------------------------------
+// Read the controls the send thread follows and hand them over. The rate is
+// held within what the configured port carries.
+//-----------------------------------------------------------------------------
+void PublishSettings()
+{
+	SendSettings *settings = SnapshotBack (&settingsSnapshot);
+	double limit;
+
+	GetCtrlVal (panelHandle, PANEL_SR, &settings->rate);
+	GetCtrlVal (panelHandle, burstControl, &settings->burst);
+	GetCtrlVal (panelHandle, encodingControl, &settings->encoding);
+	GetCtrlVal (panelHandle, blockSizeControl, &settings->blockSize);
+	GetCtrlVal (panelHandle, sourceControl, &settings->source);
+	limit = LinkRateLimit(settings->encoding, settings->blockSize);
+	if (settings->rate > limit)
+		SetCtrlVal (panelHandle, PANEL_SR, settings->rate = limit);
+
+	GetCtrlVal (panelHandle, startControl, &settings->start);
+	GetCtrlVal (panelHandle, endControl, &settings->end);
+	GetCtrlVal (panelHandle, playbackModeControl, &settings->mode);
+	GetCtrlVal (panelHandle, speedControl, &settings->speed);
+	GetCtrlVal (panelHandle, seekControl, &settings->seekPosition);
+	settings->seekCount = seekCount;
+
+	ReadGeneratorControls (&settings->model);
+	SnapshotPublish (&settingsSnapshot);
+}
+
+//-----------------------------------------------------------------------------
+// Show the send thread's counters: the rate actually sent and the share of
+// time stalled since the last tick, and a blink of the LED when anything was sent
+//-----------------------------------------------------------------------------
+void ShowCounters()
+{
+	static unsigned int lastSent = 0;
+	static unsigned int lastStalledTime = 0;
+	static double lastTime = 0;
+	static int led = 0;
+	unsigned int sent = AtomicLoad (&counters.vectorsSent);
+	unsigned int stalledTime = AtomicLoad (&counters.stalledTime);
+	double now = Timer();
+
+	// The counts wrap, the unsigned differences do not mind
+	if (lastTime > 0 && now > lastTime)
+	{
+		SetCtrlVal (panelHandle, rateIndicator, (sent - lastSent) / (now - lastTime));
+		SetCtrlVal (panelHandle, stalledIndicator, (stalledTime - lastStalledTime) / (10.0 * (now - lastTime)));
+	}
+	SetCtrlVal (panelHandle, PANEL_CHECKSUM, (unsigned char)AtomicLoad (&counters.checksum));
+	SetCtrlVal (panelHandle, PANEL_NUM, (int)AtomicLoad (&counters.bytesWritten));
+	SetCtrlVal (panelHandle, PANEL_OUTPUT_QUE, GetOutQLen(comport));
+	SetCtrlVal (panelHandle, slipsIndicator, AtomicLoad (&counters.slips));
+	SetCtrlVal (panelHandle, stallsIndicator, AtomicLoad (&counters.stalls));
+	SetCtrlVal (panelHandle, positionIndicator, AtomicLoad (&counters.position));
+
+	// LED blink to indicate data sent
+	SetCtrlVal (panelHandle, PANEL_LED, led = sent != lastSent && !led);
+
+	lastSent = sent;
+	lastStalledTime = stalledTime;
+	lastTime = now;
+}
+
+//-----------------------------------------------------------------------------
+// Follow the controls and show the send thread's progress, on the UI thread
+//-----------------------------------------------------------------------------
+static int CVICALLBACK UpdateTimerCallback (int panel, int control, int event,
+											void *callbackData, int eventData1, int eventData2)
+{
+	switch (event)
+	{
+		case EVENT_TIMER_TICK:
+			PublishSettings();
+			ShowCounters();
+			break;
+	}
+	return 0;
 }
 
 int CVICALLBACK QuitCallback (int panel, int control, int event,
@@ -153,6 +484,7 @@ int CVICALLBACK QuitCallback (int panel, int control, int event,
 	{
 		case EVENT_COMMIT:
 			quitting = 1;
+			SetCtrlAttribute (panelHandle, updateTimer, ATTR_ENABLED, 0);
 			if (threadFunctionId)
 			{
 				// Wait for thread function Completion
@@ -160,8 +492,6 @@ int CVICALLBACK QuitCallback (int panel, int control, int event,
 														threadFunctionId, OPT_TP_PROCESS_EVENTS_WHILE_WAITING);
 				// Release thread function
 				CmtReleaseThreadPoolFunctionID (DEFAULT_THREAD_POOL_HANDLE, threadFunctionId);
-
-				CmtDiscardLock (lock);
 			}
 			if (port_open)
 			{
@@ -182,3 +512,268 @@ unsigned int Connected(int portNumber)
 {
 	return (GetComLineStatus(portNumber) & kRS_DSR_ON);
 }
+
+//-----------------------------------------------------------------------------
+// Whether the receiver lets data through, always without flow control. The
+// driver holds its output on CTS off or an XOFF, which GetOutQLen alone
+// doesn't tell apart from a slow link. Clearing the line errors does no harm,
+// the transmitter never reads the port.
+//-----------------------------------------------------------------------------
+unsigned int ClearToSend(int portNumber)
+{
+	COMSTAT status;
+	DWORD errors;
+
+	if (!port.ctsFlow && !port.xonFlow)
+		return 1;
+	if (!ClearCommError ((HANDLE)port.handle, &errors, &status))
+		return !port.ctsFlow || (GetComLineStatus(portNumber) & kRS_CTS_ON);
+	return !status.fCtsHold && !status.fXoffHold;
+}
+
+//-----------------------------------------------------------------------------
+// Bytes of the port's output queue, and the bytes free
+//-----------------------------------------------------------------------------
+size_t OutputQueueSize()
+{
+	return port.outputQueue;
+}
+
+size_t OutputQueueRoom(int portNumber)
+{
+	int queued = GetOutQLen(portNumber);
+
+	if (queued < 0 || (size_t)queued >= OutputQueueSize())
+		return 0;
+	return OutputQueueSize() - queued;
+}
+
+//-----------------------------------------------------------------------------
+// Read the line settings of an open port. Returns -1 when they can't be read.
+//-----------------------------------------------------------------------------
+int ReadPortSettings(int portNumber)
+{
+	intptr_t handle;
+	DCB dcb;
+	COMMPROP properties;
+
+	memset(&dcb, 0, sizeof(dcb));
+	dcb.DCBlength = sizeof(dcb);
+	if (GetSystemComHandle (portNumber, &handle) < 0 || !GetCommState ((HANDLE)handle, &dcb))
+		return -1;
+
+	port.handle = handle;
+	port.baudrate = dcb.BaudRate;
+	// Start bit, data bits, optional parity bit and stop bits, 1.5 stop bits counted as 2
+	port.bitsPerByte = 1 + dcb.ByteSize + (dcb.Parity != NOPARITY ? 1 : 0) + (dcb.StopBits == ONESTOPBIT ? 1 : 2);
+	port.ctsFlow = dcb.fOutxCtsFlow;
+	port.xonFlow = dcb.fOutX;
+
+	// Not every driver reports the queue size it was opened with
+	memset(&properties, 0, sizeof(properties));
+	if (GetCommProperties ((HANDLE)handle, &properties) && properties.dwCurrentTxQueue > 0)
+		port.outputQueue = properties.dwCurrentTxQueue;
+	else
+		port.outputQueue = DEFAULT_OUTPUT_QUEUE;
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Highest vector rate the configured port carries with full frames
+//-----------------------------------------------------------------------------
+double LinkRateLimit(int encoding, int blockSize)
+{
+	int frameSize;
+
+	if (blockSize > 1)
+		frameSize = FrameSize (FRAME_TYPE_BLOCK | encoding, blockSize);
+	else
+		frameSize = FrameSize (encoding, 1);
+	return PacerMaxRate (port.baudrate, port.bitsPerByte, frameSize) * blockSize;
+}
+
+//-----------------------------------------------------------------------------
+// Release at least a block of vectors at a time so block frames fill up
+//-----------------------------------------------------------------------------
+unsigned int PacedBurst(int burst, int blockSize)
+{
+	return (unsigned int)(burst > blockSize ? burst : blockSize);
+}
+
+//-----------------------------------------------------------------------------
+// Generator settings from the controls, on every axis alike
+//-----------------------------------------------------------------------------
+void ReadGeneratorControls(GeneratorModel *model)
+{
+	double toneAmplitude, mainsAmplitude, step;
+	int axis;
+
+	GeneratorDefaultModel (model);
+	model->numTones = 1;
+	GetCtrlVal (panelHandle, toneFrequencyControl, &model->tones[0].frequency);
+	GetCtrlVal (panelHandle, toneAmplitudeControl, &toneAmplitude);
+	GetCtrlVal (panelHandle, mainsControl, &model->mainsFrequency);
+	GetCtrlVal (panelHandle, mainsAmplitudeControl, &mainsAmplitude);
+	GetCtrlVal (panelHandle, whiteNoiseControl, &model->whiteNoise);
+	GetCtrlVal (panelHandle, pinkNoiseControl, &model->pinkNoise);
+	GetCtrlVal (panelHandle, stepControl, &step);
+	GetCtrlVal (panelHandle, stepIntervalControl, &model->stepInterval);
+	for (axis = 0; axis < GENERATOR_NUM_ELEMENTS; axis++)
+	{
+		model->tones[0].amplitude[axis] = toneAmplitude;
+		model->mainsAmplitude[axis] = mainsAmplitude;
+		model->step[axis] = step;
+	}
+}
+
+static int CVICALLBACK SeekCallback (int panel, int control, int event,
+									 void *callbackData, int eventData1, int eventData2)
+{
+	switch (event)
+	{
+		case EVENT_COMMIT:
+			// Counted rather than flagged, so no seek is lost between two publications
+			seekCount++;
+			PublishSettings();
+			break;
+	}
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Numeric control for a generator setting, in nT, Hz or seconds
+//-----------------------------------------------------------------------------
+int NewGeneratorControl(const char *label, int top, int left, double value)
+{
+	int control = NewCtrl (panelHandle, CTRL_NUMERIC_LS, label, top, left);
+
+	SetCtrlAttribute (panelHandle, control, ATTR_DATA_TYPE, VAL_DOUBLE);
+	SetCtrlAttribute (panelHandle, control, ATTR_MIN_VALUE, 0.0);
+	SetCtrlAttribute (panelHandle, control, ATTR_CHECK_RANGE, VAL_COERCE);
+	SetCtrlVal (panelHandle, control, value);
+	return control;
+}
+
+//-----------------------------------------------------------------------------
+// Create the controls that are not part of the .uir, below the rate control,
+// and the playback and generator controls in columns right of them
+//-----------------------------------------------------------------------------
+void CreateControls()
+{
+	int top, left, height, width;
+
+	GetCtrlAttribute (panelHandle, PANEL_SR, ATTR_TOP, &top);
+	GetCtrlAttribute (panelHandle, PANEL_SR, ATTR_LEFT, &left);
+	GetCtrlAttribute (panelHandle, PANEL_SR, ATTR_HEIGHT, &height);
+
+	// Vectors sent together, 1 spaces them evenly
+	burstControl = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Burst", top + height + 25, left);
+	SetCtrlAttribute (panelHandle, burstControl, ATTR_DATA_TYPE, VAL_INTEGER);
+	SetCtrlAttribute (panelHandle, burstControl, ATTR_MIN_VALUE, 1);
+	SetCtrlAttribute (panelHandle, burstControl, ATTR_MAX_VALUE, MAX_BURST);
+	SetCtrlAttribute (panelHandle, burstControl, ATTR_CHECK_RANGE, VAL_COERCE);
+	SetCtrlVal (panelHandle, burstControl, 1);
+
+	// Measured output rate and schedule restarts
+	rateIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Actual rate (Hz)", top + 2 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, rateIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	slipsIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Late restarts", top + 3 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, slipsIndicator, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, slipsIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	// Wire encoding, fixed point halves the frame and keeps the 0.01 nT resolution
+	encodingControl = NewCtrl (panelHandle, CTRL_RING_LS, "Encoding", top + 4 * (height + 25), left);
+	InsertListItem (panelHandle, encodingControl, -1, "Fixed 0.01 nT", FRAME_TYPE_FIXED24);
+	InsertListItem (panelHandle, encodingControl, -1, "Float64", FRAME_TYPE_FLOAT64);
+	SetCtrlVal (panelHandle, encodingControl, FRAME_TYPE_FIXED24);
+
+	// Vectors per block frame, 1 sends single-vector frames
+	blockSizeControl = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Vectors per frame", top + 5 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, blockSizeControl, ATTR_DATA_TYPE, VAL_INTEGER);
+	SetCtrlAttribute (panelHandle, blockSizeControl, ATTR_MIN_VALUE, 1);
+	SetCtrlAttribute (panelHandle, blockSizeControl, ATTR_MAX_VALUE, FRAME_MAX_VECTORS);
+	SetCtrlAttribute (panelHandle, blockSizeControl, ATTR_CHECK_RANGE, VAL_COERCE);
+	SetCtrlVal (panelHandle, blockSizeControl, DEFAULT_BLOCK_SIZE);
+
+	// Backpressure: writes held back by flow control or a full output queue
+	stallsIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Flow stalls", top + 6 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, stallsIndicator, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, stallsIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	stalledIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Stalled (%)", top + 7 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, stalledIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	// Playback of the loaded vectors
+	GetCtrlAttribute (panelHandle, PANEL_SR, ATTR_WIDTH, &width);
+	left += width + 30;
+
+	playbackModeControl = NewCtrl (panelHandle, CTRL_RING_LS, "At the end", top, left);
+	InsertListItem (panelHandle, playbackModeControl, -1, "Loop", PLAYBACK_LOOP);
+	InsertListItem (panelHandle, playbackModeControl, -1, "Ping-pong", PLAYBACK_PING_PONG);
+	InsertListItem (panelHandle, playbackModeControl, -1, "Stop", PLAYBACK_STOP);
+	SetCtrlVal (panelHandle, playbackModeControl, PLAYBACK_LOOP);
+
+	speedControl = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Playback speed", top + height + 25, left);
+	SetCtrlAttribute (panelHandle, speedControl, ATTR_DATA_TYPE, VAL_DOUBLE);
+	SetCtrlAttribute (panelHandle, speedControl, ATTR_MIN_VALUE, PLAYBACK_MIN_SPEED);
+	SetCtrlAttribute (panelHandle, speedControl, ATTR_MAX_VALUE, PLAYBACK_MAX_SPEED);
+	SetCtrlAttribute (panelHandle, speedControl, ATTR_CHECK_RANGE, VAL_COERCE);
+	SetCtrlVal (panelHandle, speedControl, 1.0);
+
+	// Range of vectors played, all of them at first
+	startControl = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "First vector", top + 2 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, startControl, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, startControl, ATTR_MAX_VALUE, (unsigned int)(data.numVectors - 1));
+	SetCtrlAttribute (panelHandle, startControl, ATTR_CHECK_RANGE, VAL_COERCE);
+
+	endControl = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "End vector", top + 3 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, endControl, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, endControl, ATTR_MIN_VALUE, 1);
+	SetCtrlAttribute (panelHandle, endControl, ATTR_MAX_VALUE, (unsigned int)data.numVectors);
+	SetCtrlAttribute (panelHandle, endControl, ATTR_CHECK_RANGE, VAL_COERCE);
+	SetCtrlVal (panelHandle, endControl, (unsigned int)data.numVectors);
+
+	// Jump to a vector, and the vector being sent
+	seekControl = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Seek to", top + 4 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, seekControl, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, seekControl, ATTR_MAX_VALUE, (unsigned int)(data.numVectors - 1));
+	SetCtrlAttribute (panelHandle, seekControl, ATTR_CHECK_RANGE, VAL_COERCE);
+	InstallCtrlCallback (panelHandle, seekControl, SeekCallback, NULL);
+
+	positionIndicator = NewCtrl (panelHandle, CTRL_NUMERIC_LS, "Position", top + 5 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, positionIndicator, ATTR_DATA_TYPE, VAL_UNSIGNED_INTEGER);
+	SetCtrlAttribute (panelHandle, positionIndicator, ATTR_CTRL_MODE, VAL_INDICATOR);
+
+	// Source of the vectors, below the playback controls
+	sourceControl = NewCtrl (panelHandle, CTRL_RING_LS, "Source", top + 6 * (height + 25), left);
+	InsertListItem (panelHandle, sourceControl, -1, "Data file", SOURCE_FILE);
+	InsertListItem (panelHandle, sourceControl, -1, "Generator", SOURCE_GENERATOR);
+	SetCtrlVal (panelHandle, sourceControl, SOURCE_FILE);
+
+	// Synthetic field, starting from the default model
+	GeneratorDefaultModel (&generator.model);
+	left += width + 30;
+
+	toneFrequencyControl = NewGeneratorControl ("Tone (Hz)", top, left, generator.model.tones[0].frequency);
+	toneAmplitudeControl = NewGeneratorControl ("Tone amplitude (nT)", top + height + 25, left, generator.model.tones[0].amplitude[2]);
+
+	mainsControl = NewCtrl (panelHandle, CTRL_RING_LS, "Mains", top + 2 * (height + 25), left);
+	SetCtrlAttribute (panelHandle, mainsControl, ATTR_DATA_TYPE, VAL_DOUBLE);
+	InsertListItem (panelHandle, mainsControl, -1, "Off", 0.0);
+	InsertListItem (panelHandle, mainsControl, -1, "50 Hz", 50.0);
+	InsertListItem (panelHandle, mainsControl, -1, "60 Hz", 60.0);
+	SetCtrlVal (panelHandle, mainsControl, generator.model.mainsFrequency);
+	mainsAmplitudeControl = NewGeneratorControl ("Mains amplitude (nT)", top + 3 * (height + 25), left, generator.model.mainsAmplitude[0]);
+
+	whiteNoiseControl = NewGeneratorControl ("White noise (nT rms)", top + 4 * (height + 25), left, generator.model.whiteNoise);
+	pinkNoiseControl = NewGeneratorControl ("1/f noise (nT rms)", top + 5 * (height + 25), left, generator.model.pinkNoise);
+	stepControl = NewGeneratorControl ("Step (nT)", top + 6 * (height + 25), left, 0.0);
+	stepIntervalControl = NewGeneratorControl ("Step interval (s)", top + 7 * (height + 25), left, 0.0);
+
+	// Control follow-up and indicators on the UI thread, enabled once the port is configured
+	updateTimer = NewCtrl (panelHandle, CTRL_TIMER, "", 0, 0);
+	SetCtrlAttribute (panelHandle, updateTimer, ATTR_INTERVAL, UI_UPDATE_INTERVAL);
+	SetCtrlAttribute (panelHandle, updateTimer, ATTR_ENABLED, 0);
+	InstallCtrlCallback (panelHandle, updateTimer, UpdateTimerCallback, NULL);
+}